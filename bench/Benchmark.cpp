@@ -0,0 +1,228 @@
+#include "Benchmark.hpp"
+#include "../include/ReportWriter.hpp"
+#include "../include/JsonWriter.hpp"
+#include "../include/AllocTracker.hpp"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+using namespace std;
+
+namespace {
+typedef chrono::steady_clock Clock;
+
+double secondsSince(Clock::time_point start) {
+    return chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Mean ns per call over one batch
+double timeBatch(const function<void()>& fn, uint64_t calls) {
+    auto start = Clock::now();
+    for (uint64_t i = 0; i < calls; i++) fn();
+    return chrono::duration<double, nano>(Clock::now() - start).count() / calls;
+}
+
+// Pick a readable unit for a duration in ns
+void printDuration(double ns) {
+    if (ns < 1e3) cout << setw(9) << setprecision(1) << ns << " ns";
+    else if (ns < 1e6) cout << setw(9) << setprecision(2) << ns / 1e3 << " us";
+    else if (ns < 1e9) cout << setw(9) << setprecision(2) << ns / 1e6 << " ms";
+    else cout << setw(9) << setprecision(2) << ns / 1e9 << " s ";
+}
+
+void printRatio(double value, double scale, int precision) {
+    if (std::isnan(value)) cout << setw(9) << "-";
+    else cout << setw(9) << setprecision(precision) << value * scale;
+}
+}
+
+Benchmark::Benchmark(const BenchmarkOptions& options) : opts(options) {
+    opts.repetitions = max(1, opts.repetitions);
+}
+
+bool Benchmark::enabled(const string& name) const {
+    return opts.filter.empty() || name.find(opts.filter) != string::npos;
+}
+
+bool Benchmark::run(const string& name, size_t items, size_t bytes,
+                    const function<void()>& fn) {
+    if (!enabled(name)) return false;
+    
+    // Warm caches, branch predictors and the allocator; at least one call
+    auto warmStart = Clock::now();
+    uint64_t warmCalls = 0;
+    do {
+        fn();
+        warmCalls++;
+    } while (secondsSince(warmStart) < opts.warmupSeconds);
+    
+    // Batch size from the warmup rate, grown until one batch is long enough
+    double perCall = secondsSince(warmStart) / warmCalls;
+    uint64_t calls = max<uint64_t>(1, static_cast<uint64_t>(opts.minSampleSeconds / max(perCall, 1e-9)));
+    while (timeBatch(fn, calls) * calls * 1e-9 < opts.minSampleSeconds * 0.5) {
+        calls *= 2;
+    }
+    
+    BenchmarkResult r;
+    r.name = name;
+    r.itemsPerOp = items;
+    r.bytesPerOp = bytes;
+    r.iterations = calls;
+    r.samples.reserve(opts.repetitions);
+    for (int rep = 0; rep < opts.repetitions; rep++) {
+        r.samples.push_back(timeBatch(fn, calls));
+    }
+    
+    // Counted separately so the reads never land inside a timed sample
+    r.allocsPerOp = NAN;
+    r.allocBytesPerOp = NAN;
+    if (PerfCounters::available() || AllocTracker::enabled()) {
+        AllocStats allocsBefore = AllocTracker::total();
+        PerfCounts before = PerfCounters::read();
+        for (uint64_t i = 0; i < calls; i++) fn();
+        r.counters = PerfCounters::read() - before;
+        AllocStats allocsAfter = AllocTracker::total();
+        if (AllocTracker::enabled()) {
+            r.allocsPerOp = static_cast<double>(allocsAfter.allocations - allocsBefore.allocations) / calls;
+            r.allocBytesPerOp = static_cast<double>(allocsAfter.bytes - allocsBefore.bytes) / calls;
+        }
+    }
+    
+    vector<double> sorted = r.samples;
+    sort(sorted.begin(), sorted.end());
+    r.median = percentile(sorted, 0.5);
+    r.p99 = percentile(sorted, 0.99);
+    r.min = sorted.front();
+    double sum = 0.0, sumSq = 0.0;
+    for (double s : sorted) {
+        sum += s;
+        sumSq += s * s;
+    }
+    r.mean = sum / sorted.size();
+    r.stdDev = sqrt(max(0.0, sumSq / sorted.size() - r.mean * r.mean));
+    
+    done.push_back(r);
+    printRow(r);
+    return true;
+}
+
+double Benchmark::percentile(const vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = static_cast<size_t>(ceil(q * sorted.size()));
+    return sorted[min(sorted.size(), max<size_t>(rank, 1)) - 1];
+}
+
+void Benchmark::printHeader() const {
+    bool counters = PerfCounters::available();
+    if (!counters) {
+        cout << "Hardware counters unavailable: " << PerfCounters::unavailableReason() << "\n\n";
+    }
+    cout << left << setw(40) << "Benchmark"
+         << right << setw(12) << "Median"
+         << setw(12) << "p99"
+         << setw(10) << "ns/item"
+         << setw(10) << "MB/s"
+         << setw(10) << "Calls";
+    if (counters) {
+        cout << setw(9) << "IPC" << setw(9) << "L1D%" << setw(9) << "LLC%" << setw(9) << "Br%";
+    }
+    if (AllocTracker::enabled()) {
+        cout << setw(10) << "Allocs" << setw(12) << "Bytes";
+    }
+    cout << "\n" << string(94 + (counters ? 36 : 0) + (AllocTracker::enabled() ? 22 : 0), '-') << "\n";
+}
+
+void Benchmark::printRow(const BenchmarkResult& r) {
+    cout << left << setw(40) << r.name << right << fixed;
+    printDuration(r.median);
+    printDuration(r.p99);
+    cout << setw(10) << setprecision(2) << (r.itemsPerOp > 0 ? r.median / r.itemsPerOp : 0.0);
+    if (r.bytesPerOp > 0) {
+        cout << setw(10) << setprecision(1) << r.bytesPerOp / r.median * 1e3;
+    } else {
+        cout << setw(10) << "-";
+    }
+    cout << setw(10) << r.iterations;
+    if (r.counters.validMask != 0) {
+        printRatio(r.counters.ipc(), 1.0, 2);
+        printRatio(r.counters.l1MissRate(), 100.0, 2);
+        printRatio(r.counters.llcMissRate(), 100.0, 2);
+        printRatio(r.counters.branchMissRate(), 100.0, 2);
+    }
+    if (!std::isnan(r.allocsPerOp)) {
+        cout << setw(10) << setprecision(1) << r.allocsPerOp
+             << setw(12) << setprecision(0) << r.allocBytesPerOp;
+    }
+    cout << "\n";
+}
+
+bool Benchmark::writeJSON(const string& filename) const {
+    ReportWriter out(filename);
+    if (!out.isOpen()) return false;
+    JsonWriter json(out);
+    
+    time_t now = time(nullptr);
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    
+    json.beginObject();
+    json.key("context").beginObject()
+        .key("date").value(date)
+#if defined(__VERSION__)
+        .key("compiler").value(__VERSION__)
+#endif
+#ifdef NDEBUG
+        .key("assertions").value(false)
+#else
+        .key("assertions").value(true)
+#endif
+        .key("repetitions").value(opts.repetitions)
+        .key("min_sample_seconds").value(opts.minSampleSeconds)
+        .key("hardware_counters").value(PerfCounters::available())
+        .key("alloc_tracking").value(AllocTracker::enabled())
+        .endObject();
+    
+    json.key("benchmarks").beginArray();
+    for (const auto& r : done) {
+        json.beginObject()
+            .key("name").value(r.name)
+            .key("items_per_op").value(r.itemsPerOp)
+            .key("bytes_per_op").value(r.bytesPerOp)
+            .key("iterations").value(static_cast<long long>(r.iterations))
+            .key("median_ns").value(r.median)
+            .key("p99_ns").value(r.p99)
+            .key("min_ns").value(r.min)
+            .key("mean_ns").value(r.mean)
+            .key("stddev_ns").value(r.stdDev)
+            .key("ns_per_item").value(r.itemsPerOp > 0 ? r.median / r.itemsPerOp : 0.0)
+            .key("bytes_per_second").value(r.bytesPerOp > 0 ? r.bytesPerOp / r.median * 1e9 : 0.0);
+        if (r.counters.validMask != 0) {
+            // Per call; missing events are null
+            json.key("counters").beginObject();
+            for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+                json.key(PerfCounters::eventName(static_cast<PerfEvent>(e)));
+                if (r.counters.has(static_cast<PerfEvent>(e))) {
+                    json.value(static_cast<double>(r.counters.value[e]) / r.iterations);
+                } else {
+                    json.null();
+                }
+            }
+            json.key("ipc").value(r.counters.ipc())
+                .key("l1d_miss_rate").value(r.counters.l1MissRate())
+                .key("llc_miss_rate").value(r.counters.llcMissRate())
+                .key("branch_miss_rate").value(r.counters.branchMissRate())
+                .endObject();
+        }
+        if (!std::isnan(r.allocsPerOp)) {
+            json.key("allocs_per_op").value(r.allocsPerOp)
+                .key("alloc_bytes_per_op").value(r.allocBytesPerOp);
+        }
+        json.key("samples_ns").beginArray();
+        for (double s : r.samples) json.value(s);
+        json.endArray().endObject();
+    }
+    json.endArray().endObject().endRecord();
+    return out.close();
+}
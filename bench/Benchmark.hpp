@@ -0,0 +1,78 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include "../include/PerfCounters.hpp"
+
+// Keep a computed value alive so the optimizer cannot drop the work behind it
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct BenchmarkOptions {
+    int repetitions = 15;              // Timed samples per benchmark
+    double warmupSeconds = 0.05;       // Untimed calls before calibration
+    double minSampleSeconds = 0.01;    // Each sample batches calls up to this
+    std::string filter;                // Run only names containing this
+};
+
+// Timings of one benchmark; every sample is the mean of `iterations` calls
+struct BenchmarkResult {
+    std::string name;
+    size_t itemsPerOp;       // Bars (or records) one call processes
+    size_t bytesPerOp;       // Input bytes one call reads (0 if not meaningful)
+    uint64_t iterations;
+    std::vector<double> samples;   // ns per call, in run order
+    double median;
+    double p99;
+    double min;
+    double mean;
+    double stdDev;
+    PerfCounts counters;     // Totals over one extra batch of `iterations` calls
+    double allocsPerOp;      // From the same batch; NaN without alloc tracking
+    double allocBytesPerOp;
+};
+
+// Minimal harness: warm up, calibrate a batch size so one sample lasts at
+// least minSampleSeconds, then take `repetitions` samples with steady_clock.
+// Rows are printed as they finish; writeJSON keeps the raw samples so two
+// runs can be compared statistically. Where perf_event_open works or
+// allocation tracking is compiled in, one more batch runs under hardware
+// counters and the allocation counters for the IPC / miss-rate / allocs columns.
+class Benchmark {
+public:
+    explicit Benchmark(const BenchmarkOptions& options);
+    
+    bool enabled(const std::string& name) const;
+    
+    // Time fn; skipped (returns false) when filtered out
+    bool run(const std::string& name, size_t items, size_t bytes,
+             const std::function<void()>& fn);
+    
+    const std::vector<BenchmarkResult>& results() const { return done; }
+    
+    void printHeader() const;
+    static void printRow(const BenchmarkResult& r);
+    
+    // {"context": {...}, "benchmarks": [{..., "samples_ns": [...]}]}
+    bool writeJSON(const std::string& filename) const;
+    
+    // Nearest-rank percentile of ascending-sorted values, q in [0, 1]
+    static double percentile(const std::vector<double>& sorted, double q);
+
+private:
+    BenchmarkOptions opts;
+    std::vector<BenchmarkResult> done;
+};
+
+#endif // BENCHMARK_HPP
@@ -0,0 +1,280 @@
+#include "BenchmarkCompare.hpp"
+#include "../include/MappedFile.hpp"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdlib>
+#include <cmath>
+#include <map>
+#include <set>
+#include <cctype>
+using namespace std;
+
+namespace {
+// Pull parser for the subset of JSON that bench writes: objects, arrays,
+// strings without escapes beyond \" and \\, numbers, true/false/null
+class JsonCursor {
+public:
+    JsonCursor(const char* begin, const char* end, const string& source)
+        : p(begin), end(end), source(source) {}
+    
+    void skipSpace() {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+    }
+    
+    bool consume(char c) {
+        skipSpace();
+        if (p < end && *p == c) {
+            p++;
+            return true;
+        }
+        return false;
+    }
+    
+    void expect(char c) {
+        if (!consume(c)) fail(string("expected '") + c + "'");
+    }
+    
+    string str() {
+        expect('"');
+        string s;
+        while (p < end && *p != '"') {
+            if (*p == '\\' && p + 1 < end) p++;
+            s.push_back(*p++);
+        }
+        expect('"');
+        return s;
+    }
+    
+    double number() {
+        skipSpace();
+        if (end - p >= 4 && string(p, 4) == "null") {
+            p += 4;
+            return NAN;
+        }
+        char* stop;
+        double v = strtod(p, &stop);
+        if (stop == p) fail("expected a number");
+        p = stop;
+        return v;
+    }
+    
+    void skipValue() {
+        skipSpace();
+        if (p >= end) fail("unexpected end of file");
+        if (*p == '"') {
+            str();
+        } else if (*p == '{' || *p == '[') {
+            char close = *p == '{' ? '}' : ']';
+            bool isObject = *p == '{';
+            p++;
+            if (consume(close)) return;
+            do {
+                if (isObject) {
+                    str();
+                    expect(':');
+                }
+                skipValue();
+            } while (consume(','));
+            expect(close);
+        } else {
+            // Number or literal
+            while (p < end && *p != ',' && *p != '}' && *p != ']' && !isspace(static_cast<unsigned char>(*p))) p++;
+        }
+    }
+    
+    [[noreturn]] void fail(const string& what) const {
+        throw runtime_error(source + ": malformed benchmark JSON (" + what + ")");
+    }
+
+private:
+    const char* p;
+    const char* end;
+    const string& source;
+};
+
+BenchmarkSamples readBenchmark(JsonCursor& json) {
+    BenchmarkSamples b;
+    b.median = NAN;
+    json.expect('{');
+    if (json.consume('}')) return b;
+    do {
+        string key = json.str();
+        json.expect(':');
+        if (key == "name") {
+            b.name = json.str();
+        } else if (key == "median_ns") {
+            b.median = json.number();
+        } else if (key == "samples_ns") {
+            json.expect('[');
+            if (!json.consume(']')) {
+                do {
+                    b.samples.push_back(json.number());
+                } while (json.consume(','));
+                json.expect(']');
+            }
+        } else {
+            json.skipValue();
+        }
+    } while (json.consume(','));
+    json.expect('}');
+    return b;
+}
+
+double median(vector<double> v) {
+    if (v.empty()) return NAN;
+    size_t mid = v.size() / 2;
+    nth_element(v.begin(), v.begin() + mid, v.end());
+    double m = v[mid];
+    if (v.size() % 2 == 0) {
+        m = (m + *max_element(v.begin(), v.begin() + mid)) / 2.0;
+    }
+    return m;
+}
+
+void printTime(double ns) {
+    if (std::isnan(ns)) cout << setw(12) << "-";
+    else if (ns < 1e3) cout << setw(9) << setprecision(1) << ns << " ns";
+    else if (ns < 1e6) cout << setw(9) << setprecision(2) << ns / 1e3 << " us";
+    else if (ns < 1e9) cout << setw(9) << setprecision(2) << ns / 1e6 << " ms";
+    else cout << setw(9) << setprecision(2) << ns / 1e9 << " s ";
+}
+}
+
+vector<BenchmarkSamples> BenchmarkCompare::load(const string& filename) {
+    MappedFile file(filename);
+    JsonCursor json(file.data(), file.data() + file.size(), filename);
+    
+    vector<BenchmarkSamples> out;
+    json.expect('{');
+    if (json.consume('}')) return out;
+    do {
+        string key = json.str();
+        json.expect(':');
+        if (key != "benchmarks") {
+            json.skipValue();
+            continue;
+        }
+        json.expect('[');
+        if (json.consume(']')) continue;
+        do {
+            BenchmarkSamples b = readBenchmark(json);
+            if (b.name.empty()) json.fail("benchmark without a name");
+            // Older files may lack samples; fall back to the median alone
+            if (b.samples.empty() && !std::isnan(b.median)) b.samples.push_back(b.median);
+            if (std::isnan(b.median)) b.median = median(b.samples);
+            out.push_back(b);
+        } while (json.consume(','));
+        json.expect(']');
+    } while (json.consume(','));
+    json.expect('}');
+    return out;
+}
+
+double BenchmarkCompare::mannWhitney(const vector<double>& a, const vector<double>& b) {
+    size_t n1 = a.size(), n2 = b.size();
+    if (n1 == 0 || n2 == 0) return 1.0;
+    
+    // Rank the pooled samples, averaging ranks over ties
+    vector<pair<double, int>> pooled;
+    pooled.reserve(n1 + n2);
+    for (double v : a) pooled.push_back({v, 0});
+    for (double v : b) pooled.push_back({v, 1});
+    sort(pooled.begin(), pooled.end());
+    
+    double rankSumA = 0.0;
+    double tieTerm = 0.0;   // sum of t^3 - t over tie groups
+    size_t n = pooled.size();
+    for (size_t i = 0; i < n;) {
+        size_t j = i;
+        while (j < n && pooled[j].first == pooled[i].first) j++;
+        double avgRank = (i + 1 + j) / 2.0;
+        for (size_t k = i; k < j; k++) {
+            if (pooled[k].second == 0) rankSumA += avgRank;
+        }
+        double t = static_cast<double>(j - i);
+        tieTerm += t * t * t - t;
+        i = j;
+    }
+    
+    double u = rankSumA - n1 * (n1 + 1) / 2.0;
+    double meanU = n1 * n2 / 2.0;
+    double varU = n1 * n2 / 12.0 * ((n + 1) - tieTerm / (static_cast<double>(n) * (n - 1)));
+    if (varU <= 0.0) return 1.0;   // Every value identical
+    
+    double z = (fabs(u - meanU) - 0.5) / sqrt(varU);
+    if (z < 0.0) z = 0.0;
+    return erfc(z / sqrt(2.0));
+}
+
+vector<BenchmarkDiff> BenchmarkCompare::compare(const vector<BenchmarkSamples>& base,
+                                                const vector<BenchmarkSamples>& next,
+                                                double threshold, double alpha) {
+    map<string, const BenchmarkSamples*> byName;
+    for (const auto& b : next) byName[b.name] = &b;
+    
+    vector<BenchmarkDiff> diffs;
+    set<string> seen;
+    for (const auto& b : base) {
+        BenchmarkDiff d;
+        d.name = b.name;
+        d.baseMedian = b.median;
+        seen.insert(b.name);
+        auto it = byName.find(b.name);
+        if (it == byName.end()) {
+            d.newMedian = NAN;
+            d.change = NAN;
+            d.pValue = NAN;
+            d.verdict = VERDICT_ONLY_BASE;
+            diffs.push_back(d);
+            continue;
+        }
+        const BenchmarkSamples& n = *it->second;
+        d.newMedian = n.median;
+        d.change = b.median > 0 ? n.median / b.median - 1.0 : 0.0;
+        d.pValue = mannWhitney(b.samples, n.samples);
+        d.verdict = VERDICT_SAME;
+        if (d.pValue < alpha && fabs(d.change) > threshold) {
+            d.verdict = d.change > 0 ? VERDICT_SLOWER : VERDICT_FASTER;
+        }
+        diffs.push_back(d);
+    }
+    for (const auto& n : next) {
+        if (seen.count(n.name)) continue;
+        diffs.push_back({n.name, NAN, n.median, NAN, NAN, VERDICT_ONLY_NEW});
+    }
+    return diffs;
+}
+
+const char* BenchmarkCompare::verdictName(CompareVerdict verdict) {
+    switch (verdict) {
+        case VERDICT_SAME: return "";
+        case VERDICT_FASTER: return "faster";
+        case VERDICT_SLOWER: return "REGRESSION";
+        case VERDICT_ONLY_BASE: return "removed";
+        case VERDICT_ONLY_NEW: return "new";
+    }
+    return "";
+}
+
+void BenchmarkCompare::printTable(const vector<BenchmarkDiff>& diffs) {
+    cout << left << setw(40) << "Benchmark"
+         << right << setw(12) << "Base"
+         << setw(12) << "New"
+         << setw(10) << "Change"
+         << setw(10) << "p-value" << "  Verdict\n";
+    cout << string(96, '-') << "\n";
+    for (const auto& d : diffs) {
+        cout << left << setw(40) << d.name << right << fixed;
+        printTime(d.baseMedian);
+        printTime(d.newMedian);
+        if (std::isnan(d.change)) {
+            cout << setw(10) << "-" << setw(10) << "-";
+        } else {
+            cout << setw(9) << showpos << setprecision(1) << d.change * 100.0 << noshowpos << "%"
+                 << setw(10) << setprecision(4) << d.pValue;
+        }
+        cout << "  " << verdictName(d.verdict) << "\n";
+    }
+}
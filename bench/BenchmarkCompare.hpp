@@ -0,0 +1,54 @@
+#ifndef BENCHMARKCOMPARE_HPP
+#define BENCHMARKCOMPARE_HPP
+
+#include <string>
+#include <vector>
+
+// Samples of one benchmark as read back from a bench --json file
+struct BenchmarkSamples {
+    std::string name;
+    double median;
+    std::vector<double> samples;   // ns per call
+};
+
+enum CompareVerdict {
+    VERDICT_SAME,         // Within the noise threshold or not significant
+    VERDICT_FASTER,
+    VERDICT_SLOWER,
+    VERDICT_ONLY_BASE,    // Missing from the new run
+    VERDICT_ONLY_NEW
+};
+
+struct BenchmarkDiff {
+    std::string name;
+    double baseMedian;
+    double newMedian;
+    double change;        // newMedian / baseMedian - 1
+    double pValue;        // Two-sided Mann-Whitney U
+    CompareVerdict verdict;
+};
+
+// Statistical comparison of two benchmark runs. A benchmark counts as a
+// regression only when the median slows down by more than `threshold` AND the
+// Mann-Whitney U test rejects "same distribution" at `alpha`, so one noisy
+// sample or a tiny-but-consistent shift does not fail a build.
+class BenchmarkCompare {
+public:
+    // Parse the "benchmarks" array of a bench --json file, in file order.
+    // Throws std::runtime_error on unreadable or malformed files.
+    static std::vector<BenchmarkSamples> load(const std::string& filename);
+    
+    // Two-sided p-value for H0: both samples come from one distribution.
+    // Normal approximation with tie and continuity correction.
+    static double mannWhitney(const std::vector<double>& a, const std::vector<double>& b);
+    
+    // Diffs in base order, then benchmarks that only exist in the new run
+    static std::vector<BenchmarkDiff> compare(const std::vector<BenchmarkSamples>& base,
+                                              const std::vector<BenchmarkSamples>& next,
+                                              double threshold, double alpha);
+    
+    static void printTable(const std::vector<BenchmarkDiff>& diffs);
+    static const char* verdictName(CompareVerdict verdict);
+};
+
+#endif // BENCHMARKCOMPARE_HPP
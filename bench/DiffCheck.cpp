@@ -0,0 +1,228 @@
+#include "DiffCheck.hpp"
+#include "../include/ResultCache.hpp"
+#include "../include/ReportWriter.hpp"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+using namespace std;
+
+namespace {
+// Map a double onto an integer line where adjacent values differ by one
+uint64_t orderedBits(double x) {
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return (bits >> 63) ? ~bits : bits | (1ull << 63);
+}
+
+string describe(double v) {
+    ostringstream out;
+    out << setprecision(17) << v;
+    return out.str();
+}
+
+void appendBytes(vector<char>& buf, const void* p, size_t n) {
+    const char* c = static_cast<const char*>(p);
+    buf.insert(buf.end(), c, c + n);
+}
+
+string hex16(uint64_t v) {
+    ostringstream out;
+    out << hex << setw(16) << setfill('0') << v;
+    return out.str();
+}
+}
+
+DiffCheck::DiffCheck(bool verbose) : verbose(verbose) {}
+
+uint64_t DiffCheck::ulpDistance(double a, double b) {
+    if (a == b) return 0;   // Also +0 / -0
+    if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b) ? 0 : UINT64_MAX;
+    uint64_t x = orderedBits(a), y = orderedBits(b);
+    return x > y ? x - y : y - x;
+}
+
+CheckSummary& DiffCheck::summary(const string& check) {
+    for (auto& s : checks) {
+        if (s.name == check) return s;
+    }
+    checks.push_back({check, 0, 0, 0, 0.0, "", 0, ""});
+    return checks.back();
+}
+
+void DiffCheck::fail(CheckSummary& s, const string& dataset, const string& what) {
+    s.failures++;
+    if (s.firstFailure.empty()) s.firstFailure = dataset + ": " + what;
+    if (verbose) cout << "  FAIL " << s.name << " [" << dataset << "] " << what << "\n";
+}
+
+bool DiffCheck::arrays(const string& check, const string& dataset,
+                       const vector<double>& ref, const vector<double>& got,
+                       DiffBudget budget) {
+    CheckSummary& s = summary(check);
+    s.runs++;
+    if (ref.size() != got.size()) {
+        fail(s, dataset, "length " + to_string(got.size()) + " vs reference " + to_string(ref.size()));
+        return false;
+    }
+    
+    bool ok = true;
+    for (size_t i = 0; i < ref.size(); i++) {
+        uint64_t ulps = ulpDistance(ref[i], got[i]);
+        double rel = ulps == 0 ? 0.0 : fabs(got[i] - ref[i]) / max(fabs(ref[i]), 1.0);
+        if (std::isnan(rel)) rel = INFINITY;
+        if (ulps > s.worstUlps) {
+            s.worstUlps = ulps;
+            s.worstDataset = dataset;
+        }
+        s.worstRel = max(s.worstRel, rel);
+        if (ulps > budget.maxUlps && !(rel <= budget.relTol)) {
+            if (ok) {
+                fail(s, dataset, "index " + to_string(i) + ": " + describe(got[i]) +
+                     " vs reference " + describe(ref[i]) + " (" + to_string(ulps) + " ulps)");
+            }
+            ok = false;
+        }
+    }
+    s.points += ref.size();
+    return ok;
+}
+
+bool DiffCheck::trades(const string& check, const string& dataset,
+                       const vector<Trade>& ref, const vector<Trade>& got) {
+    CheckSummary& s = summary(check);
+    s.runs++;
+    s.points += ref.size();
+    if (ref.size() != got.size()) {
+        fail(s, dataset, to_string(got.size()) + " trades vs reference " + to_string(ref.size()));
+        return false;
+    }
+    for (size_t i = 0; i < ref.size(); i++) {
+        const Trade& a = ref[i];
+        const Trade& b = got[i];
+        string field;
+        if (a.entryDate != b.entryDate) field = "entryDate";
+        else if (a.exitDate != b.exitDate) field = "exitDate";
+        else if (a.entryIndex != b.entryIndex) field = "entryIndex";
+        else if (a.exitIndex != b.exitIndex) field = "exitIndex";
+        else if (a.exitReason != b.exitReason) field = "exitReason";
+        else if (ulpDistance(a.entryPrice, b.entryPrice) != 0) field = "entryPrice";
+        else if (ulpDistance(a.exitPrice, b.exitPrice) != 0) field = "exitPrice";
+        else if (ulpDistance(a.shares, b.shares) != 0) field = "shares";
+        else if (ulpDistance(a.pnl, b.pnl) != 0) field = "pnl";
+        else if (ulpDistance(a.returnPct, b.returnPct) != 0) field = "returnPct";
+        if (!field.empty()) {
+            fail(s, dataset, "trade " + to_string(i) + " differs in " + field);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DiffCheck::metrics(const string& check, const string& dataset,
+                        const PerformanceMetrics& ref, const PerformanceMetrics& got) {
+    auto fields = [](const PerformanceMetrics& m) {
+        return vector<double>{m.totalReturn, m.cagr, m.maxDrawdown, m.sharpeRatio,
+                              static_cast<double>(m.numTrades), static_cast<double>(m.winningTrades),
+                              m.winRate, m.avgWin, m.avgLoss, m.profitFactor};
+    };
+    return arrays(check, dataset, fields(ref), fields(got), {0, 0.0});
+}
+
+bool DiffCheck::expect(const string& check, const string& dataset, bool passed,
+                       const string& what) {
+    CheckSummary& s = summary(check);
+    s.runs++;
+    s.points++;
+    if (!passed) fail(s, dataset, what);
+    return passed;
+}
+
+uint64_t DiffCheck::digest(const vector<double>& values) {
+    return ResultCache::checksum(reinterpret_cast<const char*>(values.data()),
+                                 values.size() * sizeof(double), values.size());
+}
+
+uint64_t DiffCheck::digest(const vector<Trade>& trades) {
+    vector<char> buf;
+    for (const auto& t : trades) {
+        appendBytes(buf, t.entryDate.data(), t.entryDate.size());
+        appendBytes(buf, t.exitDate.data(), t.exitDate.size());
+        appendBytes(buf, &t.entryPrice, sizeof(double));
+        appendBytes(buf, &t.exitPrice, sizeof(double));
+        appendBytes(buf, &t.shares, sizeof(double));
+        appendBytes(buf, &t.pnl, sizeof(double));
+        appendBytes(buf, &t.returnPct, sizeof(double));
+        uint64_t index[3] = {t.entryIndex, t.exitIndex, static_cast<uint64_t>(t.exitReason)};
+        appendBytes(buf, index, sizeof(index));
+    }
+    return ResultCache::checksum(buf.data(), buf.size(), trades.size());
+}
+
+void DiffCheck::recordDigest(const string& key, uint64_t value) {
+    digests[key] = value;
+}
+
+bool DiffCheck::loadGolden(const string& filename) {
+    ifstream in(filename);
+    if (!in) return false;
+    string key, value;
+    while (in >> key >> value) {
+        golden[key] = stoull(value, nullptr, 16);
+    }
+    return true;
+}
+
+bool DiffCheck::saveGolden(const string& filename) const {
+    ReportWriter out(filename);
+    if (!out.isOpen()) return false;
+    for (const auto& d : digests) {
+        out.text(d.first).put(' ').text(hex16(d.second)).put('\n');
+    }
+    return out.close();
+}
+
+void DiffCheck::checkGolden() {
+    CheckSummary& s = summary("golden");
+    for (const auto& d : digests) {
+        auto it = golden.find(d.first);
+        if (it == golden.end()) continue;   // Dataset not in the golden run
+        s.runs++;
+        s.points++;
+        if (it->second != d.second) {
+            fail(s, d.first, "digest " + hex16(d.second) + " vs golden " + hex16(it->second));
+        }
+    }
+}
+
+void DiffCheck::printSummary() const {
+    cout << left << setw(26) << "Check"
+         << right << setw(7) << "Runs"
+         << setw(11) << "Points"
+         << setw(12) << "Worst ULP"
+         << setw(12) << "Worst rel"
+         << "  " << left << setw(22) << "Worst on" << "Result\n";
+    cout << string(96, '-') << "\n";
+    for (const auto& s : checks) {
+        cout << left << setw(26) << s.name
+             << right << setw(7) << s.runs
+             << setw(11) << s.points
+             << setw(12) << (s.worstUlps == UINT64_MAX ? string("nan") : to_string(s.worstUlps))
+             << setw(12) << scientific << setprecision(1) << s.worstRel << defaultfloat
+             << "  " << left << setw(22) << (s.worstDataset.empty() ? "-" : s.worstDataset.substr(0, 21))
+             << (s.failures == 0 ? "ok" : "FAIL (" + to_string(s.failures) + ")") << "\n";
+    }
+    for (const auto& s : checks) {
+        if (s.failures > 0) cout << "\n" << s.name << ": " << s.firstFailure;
+    }
+    cout << (failures() > 0 ? "\n" : "");
+}
+
+size_t DiffCheck::failures() const {
+    size_t n = 0;
+    for (const auto& s : checks) n += s.failures;
+    return n;
+}
@@ -0,0 +1,79 @@
+#ifndef DIFFCHECK_HPP
+#define DIFFCHECK_HPP
+
+#include "../include/types.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+// How far an array may drift from its reference: an element passes when it is
+// within maxUlps units in the last place, or within relTol * max(|ref|, 1)
+struct DiffBudget {
+    uint64_t maxUlps;
+    double relTol;
+};
+
+// One check aggregated over every dataset it ran on
+struct CheckSummary {
+    std::string name;
+    size_t runs;
+    size_t points;
+    uint64_t worstUlps;
+    double worstRel;           // |got - ref| / max(|ref|, 1)
+    std::string worstDataset;
+    size_t failures;
+    std::string firstFailure;
+};
+
+// Differential checker: compares each fast path against its reference output
+// and keeps per-check statistics, so a report shows both failures and how
+// close passing checks came to their budget. Trade lists must match exactly.
+class DiffCheck {
+public:
+    explicit DiffCheck(bool verbose);
+    
+    // Distance in representable doubles; UINT64_MAX if only one side is NaN
+    static uint64_t ulpDistance(double a, double b);
+    
+    bool arrays(const std::string& check, const std::string& dataset,
+                const std::vector<double>& ref, const std::vector<double>& got,
+                DiffBudget budget);
+    
+    // Every field bit-identical, dates and exit reasons included
+    bool trades(const std::string& check, const std::string& dataset,
+                const std::vector<Trade>& ref, const std::vector<Trade>& got);
+    
+    // Metrics as an exact field-by-field array comparison
+    bool metrics(const std::string& check, const std::string& dataset,
+                 const PerformanceMetrics& ref, const PerformanceMetrics& got);
+    
+    // A yes/no property, e.g. that a corrupt input is rejected
+    bool expect(const std::string& check, const std::string& dataset, bool passed,
+                const std::string& what);
+    
+    // Golden digests: stable checksums of reference outputs, saved once and
+    // compared on later runs so changes to the reference itself are caught
+    static uint64_t digest(const std::vector<double>& values);
+    static uint64_t digest(const std::vector<Trade>& trades);
+    void recordDigest(const std::string& key, uint64_t value);
+    bool loadGolden(const std::string& filename);
+    bool saveGolden(const std::string& filename) const;
+    
+    // Compare recorded digests with the loaded golden file
+    void checkGolden();
+    
+    void printSummary() const;
+    size_t failures() const;
+
+private:
+    std::vector<CheckSummary> checks;
+    std::map<std::string, uint64_t> digests;
+    std::map<std::string, uint64_t> golden;
+    bool verbose;
+    
+    CheckSummary& summary(const std::string& check);
+    void fail(CheckSummary& s, const std::string& dataset, const std::string& what);
+};
+
+#endif // DIFFCHECK_HPP
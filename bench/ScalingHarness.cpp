@@ -0,0 +1,162 @@
+#include "ScalingHarness.hpp"
+#include "../include/ReportWriter.hpp"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <map>
+using namespace std;
+
+namespace {
+typedef chrono::steady_clock Clock;
+
+void printSeconds(double s) {
+    if (s < 1e-3) cout << setw(9) << setprecision(1) << s * 1e6 << " us";
+    else if (s < 1.0) cout << setw(9) << setprecision(2) << s * 1e3 << " ms";
+    else cout << setw(9) << setprecision(2) << s << " s ";
+}
+
+string sizeLabel(size_t bars) {
+    int exponent = 0;
+    size_t n = bars;
+    while (n >= 10 && n % 10 == 0) {
+        n /= 10;
+        exponent++;
+    }
+    if (n == 1 && exponent >= 3) return "1e" + to_string(exponent);
+    return to_string(bars);
+}
+}
+
+ScalingHarness::ScalingHarness(int repetitions) : repetitions(max(1, repetitions)) {}
+
+vector<unsigned> ScalingHarness::threadCounts(unsigned maxThreads) {
+    maxThreads = max(1u, maxThreads);
+    vector<unsigned> counts;
+    for (unsigned t = 1; t < maxThreads; t *= 2) counts.push_back(t);
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+void ScalingHarness::parallelFor(unsigned threads, size_t count,
+                                 const function<void(size_t)>& task) {
+    threads = max(1u, min<unsigned>(threads, static_cast<unsigned>(max<size_t>(count, 1))));
+    if (threads == 1) {
+        for (size_t i = 0; i < count; i++) task(i);
+        return;
+    }
+    atomic<size_t> next(0);
+    vector<thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+        workers.emplace_back([&] {
+            size_t i;
+            while ((i = next.fetch_add(1)) < count) task(i);
+        });
+    }
+    for (auto& w : workers) w.join();
+}
+
+void ScalingHarness::measure(const string& workload, size_t bars, uint64_t items,
+                             const vector<unsigned>& threads,
+                             const function<void(unsigned)>& run) {
+    double base = 0.0;
+    for (unsigned t : threads) {
+        double best = INFINITY;
+        for (int rep = 0; rep < repetitions; rep++) {
+            auto start = Clock::now();
+            run(t);
+            best = min(best, chrono::duration<double>(Clock::now() - start).count());
+        }
+        if (t == 1) base = best;
+        
+        ScalingPoint p;
+        p.workload = workload;
+        p.bars = bars;
+        p.threads = t;
+        p.items = items;
+        p.seconds = best;
+        p.speedup = base > 0.0 && best > 0.0 ? base / best : NAN;
+        p.efficiency = p.speedup / t;
+        p.serialFraction = t > 1 ? (1.0 / p.speedup - 1.0 / t) / (1.0 - 1.0 / t) : NAN;
+        done.push_back(p);
+        printRow(p);
+    }
+}
+
+void ScalingHarness::printHeader() const {
+    cout << left << setw(12) << "Workload"
+         << right << setw(8) << "Bars"
+         << setw(9) << "Threads"
+         << setw(12) << "Time"
+         << setw(11) << "Mbars/s"
+         << setw(10) << "Speedup"
+         << setw(12) << "Efficiency"
+         << setw(10) << "Serial" << "\n";
+    cout << string(84, '-') << "\n";
+}
+
+void ScalingHarness::printRow(const ScalingPoint& p) {
+    cout << left << setw(12) << p.workload
+         << right << setw(8) << sizeLabel(p.bars)
+         << setw(9) << p.threads << fixed;
+    printSeconds(p.seconds);
+    cout << setw(11) << setprecision(2) << p.items / p.seconds / 1e6
+         << setw(9) << setprecision(2) << p.speedup << "x"
+         << setw(11) << setprecision(1) << p.efficiency * 100.0 << "%";
+    if (std::isnan(p.serialFraction)) cout << setw(10) << "-";
+    else cout << setw(9) << setprecision(1) << p.serialFraction * 100.0 << "%";
+    cout << "\n";
+}
+
+void ScalingHarness::printSummary() const {
+    // Last point of the largest size per workload (the most threads)
+    map<string, const ScalingPoint*> largest;
+    vector<string> order;
+    for (const auto& p : done) {
+        auto it = largest.find(p.workload);
+        if (it == largest.end()) {
+            order.push_back(p.workload);
+            largest[p.workload] = &p;
+        } else if (p.bars > it->second->bars ||
+                   (p.bars == it->second->bars && p.threads >= it->second->threads)) {
+            it->second = &p;
+        }
+    }
+    
+    cout << "\n=== SCALING SUMMARY ===\n";
+    for (const auto& name : order) {
+        const ScalingPoint& p = *largest[name];
+        cout << left << setw(12) << name << right << fixed << setprecision(2)
+             << p.speedup << "x on " << p.threads << " threads at " << sizeLabel(p.bars) << " bars";
+        if (p.threads > 1 && p.serialFraction >= 1.0) {
+            cout << ", no parallel gain";
+        } else if (p.threads > 1 && p.serialFraction > 0.0) {
+            cout << ", serial fraction " << setprecision(1) << p.serialFraction * 100.0
+                 << "% (Amdahl ceiling " << setprecision(1) << 1.0 / p.serialFraction << "x)";
+        }
+        cout << "\n";
+    }
+}
+
+bool ScalingHarness::writeCSV(const string& filename) const {
+    ReportWriter out(filename);
+    if (!out.isOpen()) return false;
+    
+    out.text("workload,bars,threads,items,seconds,items_per_second,speedup,efficiency,serial_fraction\n");
+    for (const auto& p : done) {
+        out.text(p.workload).put(',')
+           .integer(static_cast<long long>(p.bars)).put(',')
+           .integer(static_cast<long long>(p.threads)).put(',')
+           .integer(static_cast<long long>(p.items)).put(',')
+           .shortest(p.seconds).put(',')
+           .shortest(p.items / p.seconds).put(',')
+           .shortest(p.speedup).put(',')
+           .shortest(p.efficiency).put(',');
+        if (!std::isnan(p.serialFraction)) out.shortest(p.serialFraction);
+        out.put('\n');
+    }
+    return out.close();
+}
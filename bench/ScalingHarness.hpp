@@ -0,0 +1,60 @@
+#ifndef SCALINGHARNESS_HPP
+#define SCALINGHARNESS_HPP
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+// One (workload, data size, thread count) measurement
+struct ScalingPoint {
+    std::string workload;
+    size_t bars;             // Data size the workload was prepared with
+    unsigned threads;
+    uint64_t items;          // Bar evaluations per run (sweeps multiply bars)
+    double seconds;          // Best of the repetitions
+    double speedup;          // Against the 1-thread time of the same size
+    double efficiency;       // speedup / threads
+    double serialFraction;   // Karp-Flatt estimate; NaN at 1 thread
+};
+
+// Strong-scaling harness: the same job is timed at every thread count and
+// compared with its own 1-thread time. The Karp-Flatt metric
+//   e = (1/S - 1/p) / (1 - 1/p)
+// estimates the serial fraction behind a speedup S on p threads; if e grows
+// with p the loss is overhead (merging, contention), not Amdahl's serial part.
+class ScalingHarness {
+public:
+    explicit ScalingHarness(int repetitions);
+    
+    // 1, 2, 4, ... below maxThreads, then maxThreads itself
+    static std::vector<unsigned> threadCounts(unsigned maxThreads);
+    
+    // Time run(threads) at every count; the first count must be 1
+    void measure(const std::string& workload, size_t bars, uint64_t items,
+                 const std::vector<unsigned>& threads,
+                 const std::function<void(unsigned)>& run);
+    
+    // Hand out task indices [0, count) to `threads` workers one at a time
+    static void parallelFor(unsigned threads, size_t count,
+                            const std::function<void(size_t)>& task);
+    
+    const std::vector<ScalingPoint>& points() const { return done; }
+    
+    void printHeader() const;
+    static void printRow(const ScalingPoint& p);
+    
+    // Largest size per workload: speedup at the most threads and the Amdahl
+    // ceiling 1/e implied by its serial fraction
+    void printSummary() const;
+    
+    // Long format, one row per point, ready for plotting tools
+    bool writeCSV(const std::string& filename) const;
+
+private:
+    int repetitions;
+    std::vector<ScalingPoint> done;
+};
+
+#endif // SCALINGHARNESS_HPP
@@ -0,0 +1,95 @@
+#include "SyntheticData.hpp"
+#include "../include/RandomStream.hpp"
+#include "../include/ReportWriter.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+using namespace std;
+
+namespace {
+const double DAILY_VOL = 0.015;
+const double DAILY_DRIFT = 0.0003;
+const double START_PRICE = 100.0;
+
+// Gregorian date from days since 1970-01-01 (Hinnant's civil_from_days)
+void civilFromDays(long long z, int& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    long long era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned doe = static_cast<unsigned>(z - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    y = static_cast<int>(yoe + era * 400);
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    if (m <= 2) y++;
+}
+}
+
+string SyntheticData::weekday(size_t i) {
+    // 2000-01-03 (a Monday) is day 10959 after the epoch
+    long long day = 10959 + static_cast<long long>(i / 5) * 7 + static_cast<long long>(i % 5);
+    int y;
+    unsigned m, d;
+    civilFromDays(day, y, m, d);
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%04d-%02u-%02u", y, m, d);
+    return buf;
+}
+
+vector<double> SyntheticData::closes(size_t count, uint64_t seed) {
+    vector<double> shocks(count);
+    RandomStream(seed, 0, STREAM_TEST_DATA).normal(shocks.data(), count);
+    
+    vector<double> close(count);
+    double price = START_PRICE;
+    for (size_t i = 0; i < count; i++) {
+        price *= exp(DAILY_DRIFT - 0.5 * DAILY_VOL * DAILY_VOL + DAILY_VOL * shocks[i]);
+        close[i] = price;
+    }
+    return close;
+}
+
+vector<OHLCV> SyntheticData::bars(size_t count, uint64_t seed) {
+    vector<double> close = closes(count, seed);
+    vector<OHLCV> out(count);
+    double prev = START_PRICE;
+    for (size_t i = 0; i < count; i++) {
+        // Deterministic intraday range so high/low bracket open and close
+        double range = close[i] * DAILY_VOL * (0.5 + 0.5 * ((i * 2654435761u) % 1000) / 1000.0);
+        OHLCV& bar = out[i];
+        bar.date = weekday(i);
+        bar.open = prev;
+        bar.close = close[i];
+        bar.high = max(bar.open, bar.close) + range * 0.5;
+        bar.low = min(bar.open, bar.close) - range * 0.5;
+        bar.adjClose = bar.close;
+        bar.volume = 1000000 + static_cast<long long>((i * 40503u) % 4000000);
+        prev = close[i];
+    }
+    return out;
+}
+
+size_t SyntheticData::writeCSV(const string& filename, const vector<OHLCV>& bars) {
+    ReportWriter out(filename);
+    if (!out.isOpen()) {
+        throw runtime_error("Cannot write " + filename);
+    }
+    const char* header = "Date,Open,High,Low,Close,Adj Close,Volume\n";
+    out.text(header);
+    size_t bytes = strlen(header);
+    char line[160];
+    for (const auto& bar : bars) {
+        int n = snprintf(line, sizeof(line), "%s,%.6f,%.6f,%.6f,%.6f,%.6f,%lld\n",
+                         bar.date.c_str(), bar.open, bar.high, bar.low, bar.close,
+                         bar.adjClose, bar.volume);
+        out.text(line, n);
+        bytes += n;
+    }
+    if (!out.close()) {
+        throw runtime_error("Failed writing " + filename);
+    }
+    return bytes;
+}
@@ -0,0 +1,25 @@
+#ifndef SYNTHETICDATA_HPP
+#define SYNTHETICDATA_HPP
+
+#include "../include/types.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Reproducible price data for benchmarks: a geometric random walk with
+// 1.5% daily volatility drawn from RandomStream(seed, 0, STREAM_TEST_DATA),
+// stamped with consecutive weekdays from 2000-01-03. Bar i is the same for
+// every size, so small and large datasets share a prefix.
+class SyntheticData {
+public:
+    static std::vector<OHLCV> bars(size_t count, uint64_t seed = 42);
+    static std::vector<double> closes(size_t count, uint64_t seed = 42);
+    
+    // Same layout as the Yahoo CSVs the CLI reads; returns bytes written
+    static size_t writeCSV(const std::string& filename, const std::vector<OHLCV>& bars);
+    
+    // YYYY-MM-DD of the i-th weekday after 2000-01-03
+    static std::string weekday(size_t i);
+};
+
+#endif // SYNTHETICDATA_HPP
@@ -0,0 +1,66 @@
+#include "BenchmarkCompare.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <stdexcept>
+using namespace std;
+
+namespace {
+void printUsage(const char* programName) {
+    cout << "Usage: " << programName << " <base.json> <new.json> [options]\n\n";
+    cout << "Options:\n";
+    cout << "  --threshold <n>    Relative median slowdown tolerated as noise (default: 0.05)\n";
+    cout << "  --alpha <n>        Significance level of the Mann-Whitney test (default: 0.05)\n";
+    cout << "\nExit status: 0 no regressions, 1 significant regressions, 2 usage or input error\n";
+}
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    
+    string baseFile = argv[1];
+    string newFile = argv[2];
+    double threshold = 0.05;
+    double alpha = 0.05;
+    
+    for (int i = 3; i < argc; i++) {
+        string arg = argv[i];
+        try {
+            if (arg == "--threshold" && i + 1 < argc) {
+                threshold = stod(argv[++i]);
+            } else if (arg == "--alpha" && i + 1 < argc) {
+                alpha = stod(argv[++i]);
+            } else {
+                printUsage(argv[0]);
+                return 2;
+            }
+        } catch (const logic_error&) {
+            // stoi/stod throw invalid_argument or out_of_range
+            cerr << "Error: invalid value for " << arg << ": " << argv[i] << "\n";
+            return 2;
+        }
+    }
+    
+    try {
+        auto diffs = BenchmarkCompare::compare(BenchmarkCompare::load(baseFile),
+                                               BenchmarkCompare::load(newFile),
+                                               threshold, alpha);
+        BenchmarkCompare::printTable(diffs);
+        
+        size_t slower = 0, faster = 0;
+        for (const auto& d : diffs) {
+            if (d.verdict == VERDICT_SLOWER) slower++;
+            if (d.verdict == VERDICT_FASTER) faster++;
+        }
+        cout << "\n" << diffs.size() << " benchmarks: " << slower << " regressions, "
+             << faster << " improvements (threshold " << fixed << setprecision(1)
+             << threshold * 100.0 << "%, alpha " << defaultfloat << alpha << ")\n";
+        return slower > 0 ? 1 : 0;
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << "\n";
+        return 2;
+    }
+}
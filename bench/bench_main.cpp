@@ -0,0 +1,184 @@
+#include "Benchmark.hpp"
+#include "SyntheticData.hpp"
+#include "../include/CSVParser.hpp"
+#include "../include/TechnicalIndicators.hpp"
+#include "../include/Backtester.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <stdexcept>
+using namespace std;
+
+namespace {
+// Backtester feature set exercised by one run/ benchmark
+struct RunVariant {
+    const char* name;
+    bool rsi;
+    bool ema;
+    bool macd;
+    bool bollinger;
+    double stopLoss;
+    double takeProfit;
+    bool kelly;
+    double slippage;
+};
+
+const RunVariant RUN_VARIANTS[] = {
+    {"sma", false, false, false, false, 0.0, 0.0, false, 0.0},
+    {"ema", false, true, false, false, 0.0, 0.0, false, 0.0},
+    {"rsi", true, false, false, false, 0.0, 0.0, false, 0.0},
+    {"macd", false, false, true, false, 0.0, 0.0, false, 0.0},
+    {"bollinger", false, false, false, true, 0.0, 0.0, false, 0.0},
+    {"stops", false, false, false, false, 0.05, 0.15, false, 0.0},
+    {"kelly", false, false, false, false, 0.0, 0.0, true, 0.0},
+    {"slippage", false, false, false, false, 0.0, 0.0, false, 0.0005},
+    {"all", true, true, true, true, 0.05, 0.15, true, 0.0005}
+};
+
+Backtester makeBacktester(const vector<OHLCV>& data, const RunVariant& v) {
+    return Backtester(data, 50, 200, 100000.0, v.rsi, v.ema, v.macd, v.bollinger,
+                      v.stopLoss, v.takeProfit, 0.001, v.kelly, v.slippage);
+}
+
+void printUsage(const char* programName) {
+    cout << "Usage: " << programName << " [options]\n\n";
+    cout << "Options:\n";
+    cout << "  --filter <s>       Run only benchmarks whose name contains s\n";
+    cout << "  --json <file>      Write results with raw samples as JSON\n";
+    cout << "  --repetitions <n>  Timed samples per benchmark (default: 15)\n";
+    cout << "  --min-time <ms>    Minimum duration of one sample (default: 10)\n";
+    cout << "  --max-bars <n>     Largest data size (default: 1000000)\n";
+    cout << "  --list             Print benchmark names without running them\n";
+}
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    string jsonFile;
+    size_t maxBars = 1000000;
+    bool listOnly = false;
+    
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        try {
+            if (arg == "--filter" && i + 1 < argc) {
+                options.filter = argv[++i];
+            } else if (arg == "--json" && i + 1 < argc) {
+                jsonFile = argv[++i];
+            } else if (arg == "--repetitions" && i + 1 < argc) {
+                options.repetitions = stoi(argv[++i]);
+            } else if (arg == "--min-time" && i + 1 < argc) {
+                options.minSampleSeconds = stod(argv[++i]) / 1000.0;
+            } else if (arg == "--max-bars" && i + 1 < argc) {
+                maxBars = stoul(argv[++i]);
+            } else if (arg == "--list") {
+                listOnly = true;
+            } else {
+                printUsage(argv[0]);
+                return arg == "--help" ? 0 : 1;
+            }
+        } catch (const logic_error&) {
+            // stoi/stod throw invalid_argument or out_of_range
+            cerr << "Error: invalid value for " << arg << ": " << argv[i] << "\n";
+            return 1;
+        }
+    }
+    
+    vector<size_t> sizes;
+    for (size_t n = 1000; n <= maxBars; n *= 10) sizes.push_back(n);
+    if (sizes.empty()) {
+        cerr << "Error: --max-bars must be at least 1000\n";
+        return 1;
+    }
+    
+    Benchmark bench(options);
+    if (!listOnly) bench.printHeader();
+    
+    // Every benchmark goes through here so --list sees exactly what would run
+    auto run = [&](const string& name, size_t items, size_t bytes, const function<void()>& fn) {
+        if (listOnly) {
+            if (bench.enabled(name)) cout << name << "\n";
+            return;
+        }
+        bench.run(name, items, bytes, fn);
+    };
+    
+    try {
+        vector<OHLCV> allBars = SyntheticData::bars(sizes.back());
+        filesystem::path tempDir = filesystem::temp_directory_path();
+    
+        for (size_t n : sizes) {
+            string suffix = "/" + to_string(n);
+            vector<OHLCV> bars(allBars.begin(), allBars.begin() + n);
+            vector<double> closes;
+            closes.reserve(n);
+            for (const auto& bar : bars) closes.push_back(bar.close);
+            size_t closeBytes = n * sizeof(double);
+    
+            // CSV parsing from a file in the page cache
+            string csv = (tempDir / ("backtester_bench_" + to_string(n) + ".csv")).string();
+            if (!listOnly && bench.enabled("parse" + suffix)) {
+                size_t fileBytes = SyntheticData::writeCSV(csv, bars);
+                run("parse" + suffix, n, fileBytes, [&] {
+                    doNotOptimize(CSVParser::parse(csv));
+                });
+                filesystem::remove(csv);
+            } else {
+                run("parse" + suffix, n, 0, [] {});
+            }
+    
+            // Indicators
+            run("sma50" + suffix, n, closeBytes, [&] {
+                doNotOptimize(TechnicalIndicators::SMA(closes, 50));
+            });
+            run("ema50" + suffix, n, closeBytes, [&] {
+                doNotOptimize(TechnicalIndicators::EMA(closes, 50));
+            });
+            run("rsi14" + suffix, n, closeBytes, [&] {
+                doNotOptimize(TechnicalIndicators::RSI(closes, 14));
+            });
+            run("macd" + suffix, n, closeBytes, [&] {
+                doNotOptimize(TechnicalIndicators::MACD(closes));
+            });
+            run("stddev20" + suffix, n, closeBytes, [&] {
+                doNotOptimize(TechnicalIndicators::StdDev(closes, 20));
+            });
+            run("bollinger20" + suffix, n, closeBytes, [&] {
+                doNotOptimize(TechnicalIndicators::BollingerBand(closes));
+            });
+    
+            // Full backtests (indicators + signal loop), one engine reused
+            for (const auto& variant : RUN_VARIANTS) {
+                string name = string("run/") + variant.name + suffix;
+                if (!bench.enabled(name)) continue;
+                Backtester bt = makeBacktester(bars, variant);
+                run(name, n, 0, [&] {
+                    bt.run();
+                    doNotOptimize(bt.getTrades().size());
+                });
+            }
+    
+            string metricsName = "metrics" + suffix;
+            if (bench.enabled(metricsName)) {
+                Backtester bt = makeBacktester(bars, RUN_VARIANTS[0]);
+                bt.run();
+                run(metricsName, n, 0, [&] {
+                    doNotOptimize(bt.calculateMetrics());
+                });
+            }
+        }
+    
+        if (!jsonFile.empty() && !listOnly) {
+            if (!bench.writeJSON(jsonFile)) {
+                throw runtime_error("Cannot write " + jsonFile);
+            }
+            cout << "\nResults written to " << jsonFile << "\n";
+        }
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    
+    return 0;
+}
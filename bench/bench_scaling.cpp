@@ -0,0 +1,233 @@
+#include "ScalingHarness.hpp"
+#include "SyntheticData.hpp"
+#include "Benchmark.hpp"
+#include "../include/CSVParser.hpp"
+#include "../include/TechnicalIndicators.hpp"
+#include "../include/Backtester.hpp"
+#include "../include/UniverseReport.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+using namespace std;
+
+namespace {
+const size_t MAX_SHARDS = 64;
+
+// Parameter grid of the sweep workload; one task per pair
+const int SWEEP_SHORT[] = {5, 10, 20, 50};
+const int SWEEP_LONG[] = {100, 150, 200, 250};
+const size_t SWEEP_TASKS = 16;
+
+// Rough peak footprint per bar, used to skip sizes the machine cannot hold
+const double CSV_BYTES_PER_BAR = 70.0;
+const double SERIES_BYTES_PER_BAR = 8.0;
+const double OHLCV_BYTES_PER_BAR = 80.0;
+const double RUN_BYTES_PER_BAR = 160.0;   // Indicator, equity and return vectors of one run
+
+// Symbols of the parse/indicator/universe workloads: one per 1,000 bars up to
+// 64, so small sizes expose too little parallelism, as they would for real
+size_t shardsFor(size_t bars) {
+    return min(MAX_SHARDS, max<size_t>(1, bars / 1000));
+}
+
+size_t shardBars(size_t bars, size_t shards, size_t s) {
+    return bars / shards + (s < bars % shards ? 1 : 0);
+}
+
+double physicalMemory() {
+#ifndef _WIN32
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && pageSize > 0) return static_cast<double>(pages) * pageSize;
+#endif
+    return 8.0 * (1 << 30);
+}
+
+// Accepts 1e8 style sizes; range-checked before the cast, which is undefined
+// for negative, NaN or out-of-range values
+size_t parseBars(const string& value) {
+    double bars = stod(value);
+    if (!isfinite(bars) || bars < 1e3 || bars > 1e9) {
+        throw out_of_range("bars");
+    }
+    return static_cast<size_t>(bars);
+}
+
+bool wanted(const string& list, const string& workload) {
+    if (list.empty()) return true;
+    return ("," + list + ",").find("," + workload + ",") != string::npos;
+}
+
+void printUsage(const char* programName) {
+    cout << "Usage: " << programName << " [options]\n\n";
+    cout << "Options:\n";
+    cout << "  --workloads <list> Comma-separated subset of parse,indicators,sweep,universe\n";
+    cout << "  --threads <n>      Largest thread count (default: hardware threads)\n";
+    cout << "  --min-bars <n>     Smallest data size, from 1e3 (default: 1000)\n";
+    cout << "  --max-bars <n>     Largest data size, up to 1e9 (default: 1000000)\n";
+    cout << "  --repetitions <n>  Runs per point, best is kept (default: 3)\n";
+    cout << "  --mem-limit <MiB>  Skip sizes estimated above this (default: half of RAM)\n";
+    cout << "  --csv <file>       Write every point in long format for plotting\n";
+}
+}
+
+int main(int argc, char* argv[]) {
+    string workloads;
+    unsigned maxThreads = max(1u, thread::hardware_concurrency());
+    size_t minBars = 1000;
+    size_t maxBars = 1000000;
+    int repetitions = 3;
+    double memLimit = physicalMemory() / 2;
+    string csvFile;
+    
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        try {
+            if (arg == "--workloads" && i + 1 < argc) {
+                workloads = argv[++i];
+            } else if (arg == "--threads" && i + 1 < argc) {
+                maxThreads = max(1, stoi(argv[++i]));
+            } else if (arg == "--min-bars" && i + 1 < argc) {
+                minBars = parseBars(argv[++i]);
+            } else if (arg == "--max-bars" && i + 1 < argc) {
+                maxBars = parseBars(argv[++i]);
+            } else if (arg == "--repetitions" && i + 1 < argc) {
+                repetitions = stoi(argv[++i]);
+            } else if (arg == "--mem-limit" && i + 1 < argc) {
+                memLimit = stod(argv[++i]) * (1 << 20);
+            } else if (arg == "--csv" && i + 1 < argc) {
+                csvFile = argv[++i];
+            } else {
+                printUsage(argv[0]);
+                return arg == "--help" ? 0 : 1;
+            }
+        } catch (const logic_error&) {
+            // stoi/stod throw invalid_argument or out_of_range
+            cerr << "Error: invalid value for " << arg << ": " << argv[i] << "\n";
+            return 1;
+        }
+    }
+    
+    if (maxBars < minBars) {
+        cerr << "Error: --max-bars must not be below --min-bars\n";
+        return 1;
+    }
+    vector<size_t> sizes;
+    for (size_t n = minBars; n <= maxBars; n *= 10) sizes.push_back(n);
+    vector<unsigned> threads = ScalingHarness::threadCounts(maxThreads);
+    
+    auto tempRoot = filesystem::temp_directory_path() /
+        ("bench_scaling_" + to_string(chrono::steady_clock::now().time_since_epoch().count()));
+    
+    ScalingHarness harness(repetitions);
+    cout << "Thread counts:";
+    for (unsigned t : threads) cout << " " << t;
+    cout << "  (hardware threads: " << thread::hardware_concurrency() << ")\n\n";
+    harness.printHeader();
+    
+    try {
+        for (size_t n : sizes) {
+            size_t shards = shardsFor(n);
+            bool needFiles = wanted(workloads, "parse") || wanted(workloads, "universe");
+            
+            // Skip what the machine cannot hold instead of swapping or filling the disk
+            double diskFree = static_cast<double>(filesystem::space(filesystem::temp_directory_path()).available);
+            auto fits = [&](const string& workload, double memory, double disk) {
+                if (!wanted(workloads, workload)) return false;
+                if (memory <= memLimit && disk <= diskFree * 0.9) return true;
+                cout << "(skipping " << workload << " at " << n << " bars: needs ~"
+                     << static_cast<long long>(memory / (1 << 20)) << " MiB RAM, "
+                     << static_cast<long long>(disk / (1 << 20)) << " MiB disk)\n";
+                return false;
+            };
+            double shardRun = (n / shards + 1) * (OHLCV_BYTES_PER_BAR + RUN_BYTES_PER_BAR) * maxThreads;
+            bool doParse = fits("parse", shardRun, needFiles ? n * CSV_BYTES_PER_BAR : 0.0);
+            bool doUniverse = fits("universe", shardRun, needFiles ? n * CSV_BYTES_PER_BAR : 0.0);
+            bool doIndicators = fits("indicators", n * SERIES_BYTES_PER_BAR * 2 +
+                                     (n / shards + 1) * RUN_BYTES_PER_BAR * maxThreads, 0.0);
+            bool doSweep = fits("sweep", n * OHLCV_BYTES_PER_BAR +
+                                n * RUN_BYTES_PER_BAR * min<size_t>(maxThreads, SWEEP_TASKS), 0.0);
+            
+            // One CSV per symbol, generated shard by shard so RAM stays flat
+            vector<string> files;
+            if (doParse || doUniverse) {
+                filesystem::create_directories(tempRoot);
+                for (size_t s = 0; s < shards; s++) {
+                    string file = (tempRoot / ("S" + to_string(s) + ".csv")).string();
+                    SyntheticData::writeCSV(file, SyntheticData::bars(shardBars(n, shards, s), 42 + s));
+                    files.push_back(file);
+                }
+            }
+            
+            if (doParse) {
+                harness.measure("parse", n, n, threads, [&](unsigned t) {
+                    ScalingHarness::parallelFor(t, files.size(), [&](size_t i) {
+                        doNotOptimize(CSVParser::parse(files[i]).size());
+                    });
+                });
+            }
+            
+            if (doIndicators) {
+                vector<vector<double>> series(shards);
+                for (size_t s = 0; s < shards; s++) {
+                    series[s] = SyntheticData::closes(shardBars(n, shards, s), 42 + s);
+                }
+                harness.measure("indicators", n, n, threads, [&](unsigned t) {
+                    ScalingHarness::parallelFor(t, series.size(), [&](size_t i) {
+                        const vector<double>& c = series[i];
+                        doNotOptimize(TechnicalIndicators::SMA(c, 50).back());
+                        doNotOptimize(TechnicalIndicators::EMA(c, 50).back());
+                        doNotOptimize(TechnicalIndicators::RSI(c, 14).back());
+                        doNotOptimize(TechnicalIndicators::MACD(c).histogram.back());
+                        doNotOptimize(TechnicalIndicators::BollingerBand(c, 20).upper.back());
+                    });
+                });
+            }
+            
+            if (doSweep) {
+                vector<OHLCV> bars = SyntheticData::bars(n);
+                harness.measure("sweep", n, n * SWEEP_TASKS, threads, [&](unsigned t) {
+                    ScalingHarness::parallelFor(t, SWEEP_TASKS, [&](size_t i) {
+                        Backtester bt(bars, SWEEP_SHORT[i % 4], SWEEP_LONG[i / 4], 100000.0, false);
+                        bt.run();
+                        doNotOptimize(bt.calculateMetrics().sharpeRatio);
+                    });
+                });
+            }
+            
+            if (doUniverse) {
+                BacktestConfig config = {10, 30, 100000.0, false, false, false, false,
+                                         0.0, 0.0, 0.001, false, 0.0};
+                harness.measure("universe", n, n, threads, [&](unsigned t) {
+                    doNotOptimize(UniverseReport::run(files, config, t).symbols.size());
+                });
+            }
+            
+            if (!files.empty()) filesystem::remove_all(tempRoot);
+        }
+        
+        harness.printSummary();
+        if (!csvFile.empty()) {
+            if (!harness.writeCSV(csvFile)) {
+                throw runtime_error("Cannot write " + csvFile);
+            }
+            cout << "\nScaling table written to " << csvFile << "\n";
+        }
+    } catch (const exception& e) {
+        error_code ignored;
+        filesystem::remove_all(tempRoot, ignored);
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,589 @@
+#include "DiffCheck.hpp"
+#include "SyntheticData.hpp"
+#include "../include/CSVParser.hpp"
+#include "../include/TechnicalIndicators.hpp"
+#include "../include/Backtester.hpp"
+#include "../include/BinaryResultReader.hpp"
+#include "../include/ResultExport.hpp"
+#include "../include/ResultCache.hpp"
+#include "../include/UniverseReport.hpp"
+#include "../include/RandomStream.hpp"
+#include "../include/TradeArchive.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <charconv>
+#include <cstdlib>
+using namespace std;
+
+namespace {
+struct Dataset {
+    string name;
+    vector<OHLCV> bars;
+    string csvFile;    // Where the universe and cache checks read it from
+};
+
+// Budgets per indicator: reference and engine use different but
+// algebraically equal formulas, so a few ulps of drift are expected
+const DiffBudget SMA_BUDGET = {64, 1e-11};        // Running sum vs window sum
+const DiffBudget EMA_BUDGET = {256, 1e-12};       // (p - e) * k + e vs k * p + (1 - k) * e
+const DiffBudget RSI_BUDGET = {16, 1e-12};
+const DiffBudget STDDEV_BUDGET = {64, 1e-11};
+// MACD subtracts two nearly equal EMAs, so their error is measured against
+// a result far smaller than the prices it came from
+const DiffBudget MACD_BUDGET = {256, 1e-10};
+const DiffBudget EXACT = {0, 0.0};
+const DiffBudget SUM_ORDER_BUDGET = {64, 1e-12};  // Same terms, different summation order
+
+// Textbook reference indicators, O(n * period) and written for clarity. They
+// follow the engine's conventions: 0 before the first full window, RSI 50 and
+// RS capped at 100 when there are no losses.
+vector<double> refSMA(const vector<double>& p, int period) {
+    vector<double> out(p.size(), 0.0);
+    for (size_t i = period - 1; i < p.size() && p.size() >= static_cast<size_t>(period); i++) {
+        double sum = 0.0;
+        for (size_t j = i + 1 - period; j <= i; j++) sum += p[j];
+        out[i] = sum / period;
+    }
+    return out;
+}
+
+vector<double> refEMA(const vector<double>& p, int period) {
+    vector<double> out(p.size(), 0.0);
+    if (p.size() < static_cast<size_t>(period)) return out;
+    double k = 2.0 / (period + 1.0);
+    out[period - 1] = refSMA(vector<double>(p.begin(), p.begin() + period), period)[period - 1];
+    for (size_t i = period; i < p.size(); i++) {
+        out[i] = k * p[i] + (1.0 - k) * out[i - 1];
+    }
+    return out;
+}
+
+vector<double> refRSI(const vector<double>& p, int period) {
+    vector<double> out(p.size(), 50.0);
+    if (p.size() < static_cast<size_t>(period + 1)) return out;
+    double gain = 0.0, loss = 0.0;
+    for (int i = 1; i <= period; i++) {
+        gain += max(p[i] - p[i - 1], 0.0);
+        loss += max(p[i - 1] - p[i], 0.0);
+    }
+    gain /= period;
+    loss /= period;
+    for (size_t i = period; i < p.size(); i++) {
+        if (i > static_cast<size_t>(period)) {
+            gain = (gain * (period - 1) + max(p[i] - p[i - 1], 0.0)) / period;
+            loss = (loss * (period - 1) + max(p[i - 1] - p[i], 0.0)) / period;
+        }
+        double rs = loss == 0.0 ? 100.0 : gain / loss;
+        out[i] = 100.0 - 100.0 / (1.0 + rs);
+    }
+    return out;
+}
+
+vector<double> refStdDev(const vector<double>& p, int period) {
+    vector<double> out(p.size(), 0.0);
+    for (size_t i = period - 1; i < p.size() && p.size() >= static_cast<size_t>(period); i++) {
+        double mean = 0.0;
+        for (size_t j = i + 1 - period; j <= i; j++) mean += p[j];
+        mean /= period;
+        double ss = 0.0;
+        for (size_t j = i + 1 - period; j <= i; j++) ss += (p[j] - mean) * (p[j] - mean);
+        out[i] = sqrt(ss / period);
+    }
+    return out;
+}
+
+vector<double> minus(const vector<double>& a, const vector<double>& b) {
+    vector<double> out(a.size());
+    for (size_t i = 0; i < a.size(); i++) out[i] = a[i] - b[i];
+    return out;
+}
+
+vector<double> plusScaled(const vector<double>& a, const vector<double>& b, double k) {
+    vector<double> out(a.size());
+    for (size_t i = 0; i < a.size(); i++) out[i] = a[i] + k * b[i];
+    return out;
+}
+
+// Backtester configurations every dataset is traded with
+struct Variant {
+    const char* name;
+    BacktestConfig config;
+};
+
+const Variant VARIANTS[] = {
+    {"sma", {10, 30, 100000.0, false, false, false, false, 0.0, 0.0, 0.001, false, 0.0}},
+    {"ema_rsi", {10, 30, 100000.0, true, true, false, false, 0.0, 0.0, 0.001, false, 0.0}},
+    {"macd", {10, 30, 100000.0, false, false, true, false, 0.0, 0.0, 0.001, false, 0.0}},
+    {"bollinger", {10, 30, 100000.0, false, false, false, true, 0.0, 0.0, 0.001, false, 0.0}},
+    {"stops", {10, 30, 100000.0, false, false, false, false, 0.03, 0.08, 0.001, false, 0.0005}},
+    {"kelly", {10, 30, 100000.0, false, false, false, false, 0.0, 0.0, 0.001, true, 0.0}},
+    {"all", {50, 200, 100000.0, true, true, true, true, 0.05, 0.15, 0.001, true, 0.0005}}
+};
+
+Backtester makeBacktester(const vector<OHLCV>& bars, const BacktestConfig& c) {
+    return Backtester(bars, c.shortMA, c.longMA, c.initialCapital, c.useRSI, c.useEMA, c.useMACD,
+                      c.useBollinger, c.stopLoss, c.takeProfit, c.commission, c.useKelly, c.slippage);
+}
+
+vector<double> closesOf(const vector<OHLCV>& bars) {
+    vector<double> c(bars.size());
+    for (size_t i = 0; i < bars.size(); i++) c[i] = bars[i].close;
+    return c;
+}
+
+vector<OHLCV> fromCloses(const vector<double>& closes) {
+    vector<OHLCV> bars(closes.size());
+    for (size_t i = 0; i < closes.size(); i++) {
+        double prev = i > 0 ? closes[i - 1] : closes[i];
+        bars[i] = {SyntheticData::weekday(i), prev, max(prev, closes[i]) * 1.002,
+                   min(prev, closes[i]) * 0.998, closes[i], closes[i], 1000000};
+    }
+    return bars;
+}
+
+// Hand-made shapes that stress the edges random walks rarely reach
+vector<Dataset> edgeDatasets() {
+    vector<Dataset> out;
+    out.push_back({"edge/flat", fromCloses(vector<double>(1000, 100.0)), ""});
+    
+    vector<double> saw(3000);
+    for (size_t i = 0; i < saw.size(); i++) saw[i] = 100.0 + 10.0 * fabs(static_cast<double>(i % 40) - 20.0);
+    out.push_back({"edge/sawtooth", fromCloses(saw), ""});
+    
+    vector<double> crash = SyntheticData::closes(3000, 7);
+    for (size_t i = 1500; i < crash.size(); i++) crash[i] *= 0.45;
+    for (size_t i = 2200; i < crash.size(); i++) crash[i] *= 2.5;
+    out.push_back({"edge/gaps", fromCloses(crash), ""});
+    
+    out.push_back({"edge/short", SyntheticData::bars(150, 11), ""});
+    return out;
+}
+
+void checkIndicators(DiffCheck& diff, const Dataset& d) {
+    vector<double> c = closesOf(d.bars);
+    if (c.empty()) return;
+    
+    for (int period : {10, 50, 200}) {
+        auto sma = TechnicalIndicators::SMA(c, period);
+        diff.arrays("indicator.sma", d.name, refSMA(c, period), sma, SMA_BUDGET);
+        diff.recordDigest(d.name + "/sma" + to_string(period), DiffCheck::digest(sma));
+        
+        auto ema = TechnicalIndicators::EMA(c, period);
+        diff.arrays("indicator.ema", d.name, refEMA(c, period), ema, EMA_BUDGET);
+        diff.recordDigest(d.name + "/ema" + to_string(period), DiffCheck::digest(ema));
+    }
+    
+    auto rsi = TechnicalIndicators::RSI(c, 14);
+    diff.arrays("indicator.rsi", d.name, refRSI(c, 14), rsi, RSI_BUDGET);
+    diff.recordDigest(d.name + "/rsi14", DiffCheck::digest(rsi));
+    
+    MACDResult macd = TechnicalIndicators::MACD(c);
+    vector<double> refLine = minus(refEMA(c, 12), refEMA(c, 26));
+    vector<double> refSignal = refEMA(refLine, 9);
+    diff.arrays("indicator.macd", d.name, refLine, macd.macd, MACD_BUDGET);
+    diff.arrays("indicator.macd_signal", d.name, refSignal, macd.signal, MACD_BUDGET);
+    diff.arrays("indicator.macd_hist", d.name, minus(refLine, refSignal), macd.histogram, MACD_BUDGET);
+    diff.recordDigest(d.name + "/macd_hist", DiffCheck::digest(macd.histogram));
+    
+    auto stddev = TechnicalIndicators::StdDev(c, 20);
+    vector<double> refSd = refStdDev(c, 20);
+    diff.arrays("indicator.stddev", d.name, refSd, stddev, STDDEV_BUDGET);
+    
+    BollingerBands bb = TechnicalIndicators::BollingerBand(c, 20, 2.0);
+    vector<double> refMid = refSMA(c, 20);
+    diff.arrays("indicator.bb_upper", d.name, plusScaled(refMid, refSd, 2.0), bb.upper, SMA_BUDGET);
+    diff.arrays("indicator.bb_lower", d.name, plusScaled(refMid, refSd, -2.0), bb.lower, SMA_BUDGET);
+    diff.recordDigest(d.name + "/bb_upper", DiffCheck::digest(bb.upper));
+}
+
+// A value as the archive keeps it: the CSV trade log's text, parsed back.
+// NaN, infinities and -0 are kept as they are.
+double atPrecision(double v, int decimals) {
+    if (!std::isfinite(v)) return v;
+    char buf[400];
+    auto res = to_chars(buf, buf + sizeof(buf), v, chars_format::fixed, decimals);
+    return strtod(string(buf, res.ptr).c_str(), nullptr);
+}
+
+// Trade archive round trip against the trades at CSV precision
+void checkArchive(DiffCheck& diff, const string& id, const vector<Trade>& trades,
+                  const filesystem::path& tempDir) {
+    vector<Trade> expected = trades;
+    for (auto& t : expected) {
+        t.entryPrice = atPrecision(t.entryPrice, 2);
+        t.exitPrice = atPrecision(t.exitPrice, 2);
+        t.shares = atPrecision(t.shares, 4);
+        t.pnl = atPrecision(t.pnl, 2);
+        t.returnPct = atPrecision(t.returnPct, 2);
+    }
+    string path = (tempDir / "trades.bta").string();
+    {
+        TradeArchiveWriter archive(path);
+        archive.add("log", trades);
+        if (!archive.close()) {
+            throw runtime_error("Cannot write " + path);
+        }
+    }
+    TradeArchiveReader reader(path);
+    diff.trades("archive.roundtrip", id, expected, reader.trades(0));
+}
+
+// Values a corrupt or degenerate price series can put into a trade log
+void checkArchiveSpecialValues(DiffCheck& diff, const filesystem::path& tempDir) {
+    vector<Trade> trades = {
+        {"2020-01-02", "2020-01-10", NAN, 101.25, 10.0, NAN, NAN, 1, 6, EXIT_SIGNAL},
+        {"2020-01-13", "2020-01-20", -NAN, INFINITY, 12.5, INFINITY, -INFINITY, 7, 12, EXIT_STOP_LOSS},
+        {"2020-01-21", "2020-01-24", -0.0, -INFINITY, -0.0, -0.001, -0.0, 13, 16, EXIT_TAKE_PROFIT},
+        {"2020-01-27", "2020-02-03", 99.5, NAN, NAN, 12.34, 0.5, 17, 22, EXIT_END_OF_DATA},
+        {"2020-02-04", "2020-02-10", 100.0, 102.0, 9.75, 19.5, 2.0, 23, 27, EXIT_SIGNAL}
+    };
+    checkArchive(diff, "special_values", trades, tempDir);
+}
+
+void checkBacktests(DiffCheck& diff, const Dataset& d, const filesystem::path& tempDir,
+                    ResultCache* cache) {
+    for (const auto& v : VARIANTS) {
+        const BacktestConfig& c = v.config;
+        if (d.bars.size() <= static_cast<size_t>(max(c.shortMA, c.longMA))) continue;
+        string id = d.name + "/" + v.name;
+        
+        Backtester ref = makeBacktester(d.bars, c);
+        ref.run();
+        vector<Trade> refTrades = ref.getTrades();
+        PerformanceMetrics refMetrics = ref.calculateMetrics();
+        diff.recordDigest(id + "/trades", DiffCheck::digest(refTrades));
+        
+        // The same engine run twice must not carry state over
+        ref.run();
+        diff.trades("backtest.rerun", id, refTrades, ref.getTrades());
+        
+        // Repricing the recorded fills vs simulating with the new costs
+        BacktestConfig cheap = c;
+        cheap.commission = 0.0;
+        cheap.slippage = 0.0;
+        Backtester repriced = makeBacktester(d.bars, cheap);
+        repriced.run();
+        repriced.reprice(c.commission, c.slippage);
+        diff.trades("backtest.reprice", id, refTrades, repriced.getTrades());
+        diff.metrics("backtest.reprice_metrics", id, refMetrics, repriced.calculateMetrics());
+        
+        // Series recording in RAM and in a mapped file must not touch trading
+        Backtester inMemory = makeBacktester(d.bars, c);
+        inMemory.setRecordSeries(true);
+        inMemory.run();
+        diff.trades("backtest.series", id, refTrades, inMemory.getTrades());
+        
+        string mapPath = (tempDir / "series.bts").string();
+        Backtester mapped = makeBacktester(d.bars, c);
+        mapped.setSeriesFile(mapPath);
+        mapped.run();
+        diff.trades("backtest.series_mapped", id, refTrades, mapped.getTrades());
+        const SeriesRecorder& a = inMemory.getSeries();
+        const SeriesRecorder& b = mapped.getSeries();
+        for (size_t col = 0; col < min(a.numColumns(), b.numColumns()); col++) {
+            vector<double> x(a.column(col), a.column(col) + a.numBars());
+            vector<double> y(b.column(col), b.column(col) + b.numBars());
+            diff.arrays("series.mapped_columns", id + "/" + a.name(col), x, y, EXACT);
+        }
+        
+        // Binary export round trip (also the cache's object format)
+        BacktestResult result = ref.getResult(true);
+        string btrPath = (tempDir / "result.btr").string();
+        if (ResultExport::writeBinary(btrPath, result)) {
+            BacktestResult back = BinaryResultReader(btrPath).toResult(true);
+            diff.trades("export.binary_trades", id, result.trades, back.trades);
+            diff.metrics("export.binary_metrics", id, result.metrics, back.metrics);
+            diff.arrays("export.binary_equity", id, result.equity, back.equity, EXACT);
+        }
+        
+        checkArchive(diff, id, refTrades, tempDir);
+        
+        if (cache && !d.csvFile.empty()) {
+            CacheKey key = ResultCache::makeKey(d.csvFile, c);
+            BacktestResult cached;
+            if (cache->store(key, ref.getResult()) && cache->load(key, cached)) {
+                diff.trades("cache.roundtrip", id, refTrades, cached.trades);
+                diff.metrics("cache.metrics", id, refMetrics, cached.metrics);
+            }
+        }
+    }
+}
+
+// Damaged .btr files must be rejected with an exception, never read out of
+// bounds, and a damaged cache object must turn into a miss
+void checkCorruptBinary(DiffCheck& diff, const Dataset& d, const filesystem::path& tempDir) {
+    const BacktestConfig& c = VARIANTS[0].config;
+    Backtester bt = makeBacktester(d.bars, c);
+    bt.run();
+    BacktestResult result = bt.getResult(true);
+    string path = (tempDir / "corrupt.btr").string();
+    if (!ResultExport::writeBinary(path, result)) {
+        throw runtime_error("Cannot write " + path);
+    }
+    vector<char> good(filesystem::file_size(path));
+    ifstream(path, ios::binary).read(good.data(), good.size());
+    
+    BinaryResultHeader h;
+    memcpy(&h, good.data(), sizeof(h));
+    auto withHeader = [&](void (*edit)(BinaryResultHeader&)) {
+        vector<char> bytes = good;
+        BinaryResultHeader e = h;
+        edit(e);
+        memcpy(bytes.data(), &e, sizeof(e));
+        return bytes;
+    };
+    vector<pair<string, vector<char>>> cases;
+    cases.push_back({"truncated_header", vector<char>(good.begin(), good.begin() + 64)});
+    cases.push_back({"truncated_position", vector<char>(good.begin(), good.end() - 8)});
+    cases.push_back({"metrics_offset", withHeader([](BinaryResultHeader& e) { e.metricsOffset = 1ull << 40; })});
+    cases.push_back({"trade_count_wraps", withHeader([](BinaryResultHeader& e) {
+        e.numTrades = UINT64_MAX / e.tradeRecordSize + 2;
+    })});
+    cases.push_back({"bar_count_wraps", withHeader([](BinaryResultHeader& e) { e.numBars = 1ull << 61; })});
+    cases.push_back({"dates_offset", withHeader([](BinaryResultHeader& e) { e.datesOffset = e.fileSize; })});
+    cases.push_back({"misaligned_equity", withHeader([](BinaryResultHeader& e) { e.equityOffset += 4; })});
+    if (!result.trades.empty()) {
+        vector<char> bytes = good;
+        BinaryTrade t;
+        memcpy(&t, bytes.data() + h.tradesOffset, sizeof(t));
+        t.exitReason = 99;
+        memcpy(bytes.data() + h.tradesOffset, &t, sizeof(t));
+        cases.push_back({"exit_reason", bytes});
+    }
+    
+    for (const auto& cs : cases) {
+        ofstream(path, ios::binary | ios::trunc).write(cs.second.data(), cs.second.size());
+        bool rejected = false;
+        try {
+            BinaryResultReader(path).toResult(true);
+        } catch (const runtime_error&) {
+            rejected = true;
+        }
+        diff.expect("export.binary_corrupt", d.name + "/" + cs.first, rejected, "corrupt file was accepted");
+    }
+    
+    // Same damage inside the cache: dropped and re-simulated, not served
+    ResultCache cache((tempDir / "corrupt_cache").string());
+    CacheKey key = ResultCache::makeKey(d.csvFile, c);
+    if (cache.store(key, result)) {
+        string object = (tempDir / "corrupt_cache" / "objects" / (key.id + ".btr")).string();
+        const vector<char>& bytes = cases[2].second;
+        ofstream(object, ios::binary | ios::trunc).write(bytes.data(), bytes.size());
+        BacktestResult served;
+        bool hit = cache.load(key, served);
+        diff.expect("cache.corrupt_object", d.name, !hit && !filesystem::exists(object),
+                    "corrupt cache object was served or kept");
+    }
+    
+    // An id collision: the entry under key.id was simulated with other parameters
+    BacktestConfig other = c;
+    other.commission += 0.0005;
+    CacheKey colliding = key;
+    colliding.params = ResultCache::canonicalParams(other);
+    if (cache.store(key, result)) {
+        BacktestResult served;
+        diff.expect("cache.param_mismatch", d.name, !cache.load(colliding, served),
+                    "entry with other parameters was served");
+    }
+}
+
+// Per-symbol results exact, the equal-weight curve within summation-order drift
+void checkUniverse(DiffCheck& diff, const vector<string>& files, unsigned threads) {
+    if (files.size() < 2) return;
+    for (const auto& v : VARIANTS) {
+        UniverseSummary one = UniverseReport::run(files, v.config, 1);
+        UniverseSummary many = UniverseReport::run(files, v.config, threads);
+        string id = string("universe/") + v.name;
+        bool sameSymbols = one.symbols.size() == many.symbols.size();
+        for (size_t i = 0; sameSymbols && i < one.symbols.size(); i++) {
+            sameSymbols = one.symbols[i].symbol == many.symbols[i].symbol;
+            diff.metrics("universe.symbol_metrics", id + "/" + one.symbols[i].symbol,
+                         one.symbols[i].metrics, many.symbols[i].metrics);
+        }
+        if (!sameSymbols) {
+            diff.arrays("universe.symbol_metrics", id + " (symbol set)",
+                        vector<double>(one.symbols.size()), vector<double>(many.symbols.size()), EXACT);
+        }
+        diff.arrays("universe.equity", id, one.equity, many.equity, SUM_ORDER_BUDGET);
+    }
+}
+
+// Philox4x32-10 known-answer vectors from Random123 (kat_vectors), then the
+// batched generator against one-at-a-time draws from the same positions
+void checkRandomStream(DiffCheck& diff) {
+    struct Kat {
+        uint32_t counter[4];
+        uint32_t key[2];
+        uint32_t expected[4];
+    };
+    const Kat kats[] = {
+        {{0, 0, 0, 0}, {0, 0}, {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}},
+        {{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff},
+         {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}},
+        {{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0},
+         {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}}
+    };
+    for (size_t k = 0; k < sizeof(kats) / sizeof(kats[0]); k++) {
+        uint32_t out[4];
+        RandomStream::philox(kats[k].counter, kats[k].key, out);
+        diff.arrays("rng.philox_kat", "vector " + to_string(k + 1),
+                    vector<double>(kats[k].expected, kats[k].expected + 4),
+                    vector<double>(out, out + 4), EXACT);
+    }
+
+    for (size_t count : {1, 7, 64, 1001}) {
+        RandomStream batch(42, 3, STREAM_TEST_DATA), single(42, 3, STREAM_TEST_DATA);
+        batch.seek(5);
+        single.seek(5);
+        vector<double> got(count), ref(count);
+        batch.uniform(got.data(), count);
+        for (auto& v : ref) v = single.nextUniform();
+        diff.arrays("rng.batch_uniform", to_string(count) + " draws", ref, got, EXACT);
+
+        batch.normal(got.data(), count);
+        for (auto& v : ref) v = single.nextNormal();
+        diff.arrays("rng.batch_normal", to_string(count) + " draws", ref, got, EXACT);
+    }
+}
+
+void printUsage(const char* programName) {
+    cout << "Usage: " << programName << " [options]\n\n";
+    cout << "Options:\n";
+    cout << "  --data <path>         Real CSV file or directory of CSVs (repeatable)\n";
+    cout << "  --random <n>          Random-walk datasets (default: 8)\n";
+    cout << "  --max-bars <n>        Cap on random dataset length (default: 16000)\n";
+    cout << "  --threads <n>         Thread count compared against 1 in universe runs (default: 4)\n";
+    cout << "  --golden <file>       Compare reference digests with a saved golden file\n";
+    cout << "  --save-golden <file>  Write reference digests for later --golden runs\n";
+    cout << "  --verbose             Print every failure as it happens\n";
+}
+}
+
+int main(int argc, char* argv[]) {
+    vector<string> dataPaths;
+    size_t randomSets = 8;
+    size_t maxBars = 16000;
+    unsigned threads = 4;
+    string goldenFile;
+    string saveGoldenFile;
+    bool verbose = false;
+    
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        try {
+            if (arg == "--data" && i + 1 < argc) {
+                dataPaths.push_back(argv[++i]);
+            } else if (arg == "--random" && i + 1 < argc) {
+                randomSets = stoul(argv[++i]);
+            } else if (arg == "--max-bars" && i + 1 < argc) {
+                maxBars = stoul(argv[++i]);
+            } else if (arg == "--threads" && i + 1 < argc) {
+                threads = max(2, stoi(argv[++i]));
+            } else if (arg == "--golden" && i + 1 < argc) {
+                goldenFile = argv[++i];
+            } else if (arg == "--save-golden" && i + 1 < argc) {
+                saveGoldenFile = argv[++i];
+            } else if (arg == "--verbose") {
+                verbose = true;
+            } else {
+                printUsage(argv[0]);
+                return arg == "--help" ? 0 : 1;
+            }
+        } catch (const logic_error&) {
+            // stoi/stod throw invalid_argument or out_of_range
+            cerr << "Error: invalid value for " << arg << ": " << argv[i] << "\n";
+            return 2;
+        }
+    }
+    
+    auto tempDir = filesystem::temp_directory_path() /
+        ("diff_check_" + to_string(chrono::steady_clock::now().time_since_epoch().count()));
+    DiffCheck diff(verbose);
+    
+    try {
+        filesystem::create_directories(tempDir / "universe");
+        
+        // Random walks of 250 to 16,000 bars, then edge shapes, then real data.
+        // Names carry seed and length so golden digests never pair up mismatched data
+        vector<Dataset> datasets;
+        for (size_t s = 0; s < randomSets; s++) {
+            size_t n = max<size_t>(250, min(maxBars, size_t(250) << (2 * (s % 4))));
+            datasets.push_back({"random/" + to_string(s + 1) + "x" + to_string(n),
+                                SyntheticData::bars(n, 1000 + s), ""});
+        }
+        for (auto& d : edgeDatasets()) datasets.push_back(move(d));
+        size_t realSets = 0;
+        for (const auto& path : dataPaths) {
+            vector<string> files = filesystem::is_directory(path)
+                ? UniverseReport::listFiles(path) : vector<string>{path};
+            for (const auto& f : files) {
+                datasets.push_back({"real/" + filesystem::path(f).stem().string(), CSVParser::parse(f), f});
+                realSets++;
+            }
+        }
+        
+        // Synthetic sets get a CSV too so the cache and universe checks can read them
+        vector<string> universeFiles;
+        for (auto& d : datasets) {
+            if (d.csvFile.empty()) {
+                string name = d.name;
+                replace(name.begin(), name.end(), '/', '_');
+                d.csvFile = (tempDir / "universe" / (name + ".csv")).string();
+                SyntheticData::writeCSV(d.csvFile, d.bars);
+            }
+            universeFiles.push_back(d.csvFile);
+        }
+        sort(universeFiles.begin(), universeFiles.end());
+        
+        cout << "Differential check: " << datasets.size() << " datasets ("
+             << randomSets << " random, 4 edge, " << realSets << " real), "
+             << sizeof(VARIANTS) / sizeof(VARIANTS[0]) << " engine configurations\n\n";
+        
+        ResultCache cache((tempDir / "cache").string());
+        for (const auto& d : datasets) {
+            checkIndicators(diff, d);
+            checkBacktests(diff, d, tempDir, &cache);
+        }
+        checkCorruptBinary(diff, datasets.front(), tempDir);
+        checkArchiveSpecialValues(diff, tempDir);
+        checkUniverse(diff, universeFiles, threads);
+        checkRandomStream(diff);
+        
+        if (!goldenFile.empty()) {
+            if (!diff.loadGolden(goldenFile)) {
+                throw runtime_error("Cannot read " + goldenFile);
+            }
+            diff.checkGolden();
+        }
+        diff.printSummary();
+        
+        if (!saveGoldenFile.empty()) {
+            if (!diff.saveGolden(saveGoldenFile)) {
+                throw runtime_error("Cannot write " + saveGoldenFile);
+            }
+            cout << "\nGolden digests written to " << saveGoldenFile << "\n";
+        }
+    } catch (const exception& e) {
+        error_code ignored;
+        filesystem::remove_all(tempDir, ignored);
+        cerr << "Error: " << e.what() << "\n";
+        return 2;
+    }
+    
+    error_code ignored;
+    filesystem::remove_all(tempDir, ignored);
+    if (diff.failures() > 0) {
+        cout << "\n" << diff.failures() << " differential check(s) failed\n";
+        return 1;
+    }
+    cout << "\nAll differential checks passed\n";
+    return 0;
+}
@@ -0,0 +1,48 @@
+#ifndef ALLOCTRACKER_HPP
+#define ALLOCTRACKER_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+// Build with -DBACKTESTER_ALLOC_TRACKING=1 to replace the global operator
+// new/delete with counting versions. Off by default: every allocation then
+// pays a few relaxed atomic adds.
+#ifndef BACKTESTER_ALLOC_TRACKING
+#define BACKTESTER_ALLOC_TRACKING 0
+#endif
+
+// Allocation totals of one stage (or of the whole process)
+struct AllocStats {
+    uint64_t allocations;
+    uint64_t bytes;
+    uint64_t frees;
+};
+
+// Heap accounting behind --profile. Allocations are charged to the profile
+// stage that is open on the allocating thread (ScopedTimer sets it), or to
+// "other" outside any stage. Live bytes use malloc_usable_size, so the heap
+// high-water mark includes allocator rounding.
+class AllocTracker {
+public:
+    static const int OTHER_STAGE = -1;
+    
+    // True when the counting operator new is compiled in
+    static bool enabled();
+    
+    // Charge the calling thread's allocations to stage; returns the previous
+    // stage so nested scopes can restore it
+    static int enterStage(int stage);
+    static void leaveStage(int previous);
+    
+    // stage is a ProfileStage or OTHER_STAGE
+    static AllocStats stats(int stage);
+    static AllocStats total();
+    
+    static uint64_t liveBytes();
+    static uint64_t peakLiveBytes();
+    
+    // Resident set high-water mark from getrusage (works without tracking)
+    static uint64_t peakRssBytes();
+};
+
+#endif // ALLOCTRACKER_HPP
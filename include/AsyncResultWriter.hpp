@@ -0,0 +1,75 @@
+#ifndef ASYNCRESULTWRITER_HPP
+#define ASYNCRESULTWRITER_HPP
+
+#include "types.hpp"
+#include <string>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+enum ExportFormat {
+    EXPORT_CSV,
+    EXPORT_BINARY,
+    EXPORT_JSON,
+    EXPORT_HTML      // Needs the per-bar series in the result
+};
+
+// A finished run waiting to be serialized
+struct ExportJob {
+    std::string filename;
+    ExportFormat format;
+    BacktestResult result;
+};
+
+// Background writer: producers hand finished results to a bounded queue and
+// return immediately; one writer thread serializes them and fsyncs every
+// syncBatch files (or whenever the queue drains). submit() blocks while the
+// queue is full, so a slow disk throttles producers instead of growing memory.
+// failedWrites() counts files whose write, close or fsync failed; it is final
+// once close() has returned.
+class AsyncResultWriter {
+public:
+    explicit AsyncResultWriter(size_t queueCapacity = 64, size_t syncBatch = 16);
+    ~AsyncResultWriter();
+    
+    AsyncResultWriter(const AsyncResultWriter&) = delete;
+    AsyncResultWriter& operator=(const AsyncResultWriter&) = delete;
+    
+    // Enqueue a job, waiting for space if the queue is full
+    void submit(ExportJob job);
+    
+    // Drain the queue, sync outstanding files and stop the writer thread
+    void close();
+    
+    size_t queueDepth() const;
+    size_t filesWritten() const { return written.load(); }
+    size_t failedWrites() const { return failed.load(); }
+    size_t blockedSubmits() const { return blocked.load(); }
+
+private:
+    size_t capacity;
+    size_t syncBatch;
+    
+    mutable std::mutex mtx;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<ExportJob> queue;
+    bool closing;
+    
+    std::atomic<size_t> written;
+    std::atomic<size_t> failed;
+    std::atomic<size_t> blocked;
+    std::thread worker;
+    
+    void run();
+    // Serialize one job; false on any open, write or close error
+    static bool write(const ExportJob& job);
+    
+    // fsync and forget paths; files that fail move from written to failed
+    void syncFiles(std::vector<std::string>& paths);
+};
+
+#endif // ASYNCRESULTWRITER_HPP
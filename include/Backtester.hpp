@@ -2,6 +2,7 @@
 #define BACKTESTER_HPP
 
 #include "types.hpp"
+#include "SeriesRecorder.hpp"
 #include <vector>
 #include <string>
 
@@ -9,6 +10,7 @@ class Backtester {
 private:
     std::vector<OHLCV> data;
     std::vector<Trade> trades;
+    std::vector<Fill> fills;
     
     // Strategy parameters
     int shortPeriod;
@@ -23,14 +25,22 @@ private:
     double stopLossPercent;
     double takeProfitPercent;
     double commissionRate;
+    double slippageRate;
     
     // Position tracking
     double currentCash;
     double currentShares;
     bool inPosition;
+    double entryQuote;   // Unslipped entry price; stops are measured from it
     
     // Kelly Criterion
     bool useKellyCriterion;
+    
+    // Optional per-bar series (O(bars) memory, off by default)
+    bool recordSeries;
+    std::string seriesPath;   // Non-empty: record into this mapped file
+    SeriesRecorder series;
+    double equityPeak;
 
 public:
     Backtester(const std::vector<OHLCV>& d, 
@@ -44,33 +54,83 @@ public:
                double stopLoss = 0.0,
                double takeProfit = 0.0,
                double commission = 0.001,
-               bool kelly = false);
+               bool kelly = false,
+               double slippage = 0.0);
+    
+    // Record equity, cash, position, drawdown and active indicators per bar
+    void setRecordSeries(bool enable) { recordSeries = enable; }
+    
+    // Record the equity/cash/position/drawdown columns straight into a
+    // memory-mapped file (SeriesFileHeader layout) instead of RAM
+    void setSeriesFile(const std::string& path) { recordSeries = true; seriesPath = path; }
+    const SeriesRecorder& getSeries() const { return series; }
+    
+    // Stream the recorded series as CSV (requires setRecordSeries before run)
+    bool exportSeries(const std::string& filename) const;
     
     // Run the backtest
     void run();
     
+    // Re-price the recorded fill sequence under new costs without
+    // recomputing indicators or signals - O(trades) instead of O(bars)
+    void reprice(double commission, double slippage);
+    
     // Calculate performance metrics
     PerformanceMetrics calculateMetrics() const;
     
+    // Performance metrics broken down by regime label (one label per bar)
+    std::vector<PerformanceMetrics> calculateRegimeMetrics(const std::vector<int>& labels,
+                                                           int numRegimes) const;
+    
     // Export results to file
     void exportResults(const std::string& filename) const;
     
+    // Export metrics, trades and per-bar equity/position in the binary format
+    void exportBinary(const std::string& filename) const;
+    
+    // Detached copy of the run's outputs; series add O(bars) memory
+    BacktestResult getResult(bool includeSeries = false) const;
+    
     // Print summary to console
     void printSummary() const;
+    static void printSummary(double initialCapital, double finalValue,
+                             const PerformanceMetrics& metrics);
+    
+    // Parameter set this backtester was constructed with
+    BacktestConfig getConfig() const;
     
     // Get trades for analysis
     const std::vector<Trade>& getTrades() const { return trades; }
+    const std::vector<Fill>& getFills() const { return fills; }
+    
+    // Per-bar portfolio returns (first bar is 0), aligned with the input data
+    std::vector<double> getBarReturns() const;
 
 private:
     // Position management
     void enterPosition(size_t idx);
-    void exitPosition(size_t idx);
+    void exitPosition(size_t idx, ExitReason reason);
+    
+    // Cost application shared by run() and reprice()
+    void applyEntry(const Fill& fill);
+    void applyExit(const Fill& fill);
+    double quotePrice(size_t idx) const;
     
     // Performance calculations
     double calculateMaxDrawdown() const;
     double calculateSharpeRatio() const;
     double calculateYears(const std::string& start, const std::string& end) const;
     
+    // Mark-to-market portfolio value at every bar, reconstructed from the trade log
+    // (position optionally receives shares held at each bar)
+    void buildEquityCurve(std::vector<double>& equity,
+                          std::vector<double>* position = nullptr) const;
+    
+    double finalValue() const;
+    
+    // Store the engine state after bar idx into the fixed series columns
+    void recordBar(size_t idx, double close);
+    
     // Kelly Criterion for position sizing
     double calculateKellyFraction() const;
     
@@ -0,0 +1,81 @@
+#ifndef BINARYRESULTFORMAT_HPP
+#define BINARYRESULTFORMAT_HPP
+
+#include <cstdint>
+
+// On-disk layout of binary result files (.btr), little-endian.
+// Every section starts on an 8-byte boundary so a mapped file can be read
+// in place:  header | metrics | trades[numTrades] | barDates[numBars] |
+//            equity[numBars] | position[numBars]
+// Readers accept any file whose major version matches; minor bumps may only
+// append fields to the end of a section and must raise the record sizes.
+
+const char BINARY_RESULT_MAGIC[8] = {'B', 'T', 'R', 'E', 'S', 'U', 'L', 'T'};
+const uint16_t BINARY_RESULT_MAJOR = 1;
+const uint16_t BINARY_RESULT_MINOR = 0;
+
+// Dates are stored NUL-padded; longer strings are truncated
+const int BINARY_DATE_CHARS = 24;
+
+struct BinaryResultHeader {
+    char magic[8];
+    uint16_t major;
+    uint16_t minor;
+    uint32_t headerSize;
+    uint32_t metricsSize;
+    uint32_t tradeRecordSize;
+    uint64_t numTrades;
+    uint64_t numBars;
+    uint64_t metricsOffset;
+    uint64_t tradesOffset;
+    uint64_t datesOffset;
+    uint64_t equityOffset;
+    uint64_t positionOffset;
+    uint64_t fileSize;
+    char reserved[40];
+};
+static_assert(sizeof(BinaryResultHeader) == 128, "binary header must stay 128 bytes");
+
+struct BinaryMetrics {
+    // Configuration
+    int32_t shortMA;
+    int32_t longMA;
+    uint32_t flags;          // bit 0 RSI, 1 EMA, 2 MACD, 3 Bollinger, 4 Kelly
+    uint32_t reserved;
+    double initialCapital;
+    double stopLoss;
+    double takeProfit;
+    double commission;
+    double slippage;
+    
+    // Results
+    double finalValue;
+    double totalReturn;
+    double cagr;
+    double maxDrawdown;
+    double sharpeRatio;
+    int64_t numTrades;
+    int64_t winningTrades;
+    double winRate;
+    double avgWin;
+    double avgLoss;
+    double profitFactor;
+};
+static_assert(sizeof(BinaryMetrics) % 8 == 0, "metrics block must stay 8-byte aligned");
+
+struct BinaryTrade {
+    char entryDate[BINARY_DATE_CHARS];
+    char exitDate[BINARY_DATE_CHARS];
+    double entryPrice;
+    double exitPrice;
+    double shares;
+    double pnl;
+    double returnPct;
+    uint64_t entryIndex;
+    uint64_t exitIndex;
+    uint32_t exitReason;
+    uint32_t reserved;
+};
+static_assert(sizeof(BinaryTrade) % 8 == 0, "trade record must stay 8-byte aligned");
+
+#endif // BINARYRESULTFORMAT_HPP
@@ -0,0 +1,37 @@
+#ifndef BINARYRESULTREADER_HPP
+#define BINARYRESULTREADER_HPP
+
+#include "types.hpp"
+#include "BinaryResultFormat.hpp"
+#include "MappedFile.hpp"
+#include <string>
+
+// Zero-parse reader for .btr files: the file is mapped and every accessor
+// points straight into it. Throws std::runtime_error on malformed input.
+class BinaryResultReader {
+public:
+    explicit BinaryResultReader(const std::string& filename);
+    
+    const BinaryResultHeader& header() const { return *hdr; }
+    const BinaryMetrics& metrics() const;
+    
+    size_t numTrades() const { return static_cast<size_t>(hdr->numTrades); }
+    const BinaryTrade& trade(size_t i) const;
+    
+    size_t numBars() const { return static_cast<size_t>(hdr->numBars); }
+    const double* equity() const;
+    const double* position() const;
+    std::string barDate(size_t i) const;
+    
+    // Materialize into engine types
+    BacktestResult toResult(bool includeSeries = true) const;
+    
+    // Converter to the human-readable results.csv layout
+    bool toCSV(const std::string& filename) const;
+
+private:
+    MappedFile file;
+    const BinaryResultHeader* hdr;
+};
+
+#endif // BINARYRESULTREADER_HPP
@@ -0,0 +1,25 @@
+#ifndef HTMLREPORT_HPP
+#define HTMLREPORT_HPP
+
+#include "types.hpp"
+#include <string>
+#include <vector>
+
+// Self-contained HTML report (inline SVG + a few lines of script, no external
+// assets): metrics table, equity curve with trade markers, drawdown. Curves are
+// reduced to at most maxPoints with LTTB, so page size does not grow with the
+// bar count. Needs the per-bar series (getResult(true)).
+class HtmlReport {
+public:
+    static const size_t DEFAULT_POINTS = 1500;
+    
+    static bool write(const std::string& filename,
+                      const BacktestResult& result,
+                      size_t maxPoints = DEFAULT_POINTS);
+    
+    // Largest-Triangle-Three-Buckets over y[i] at x = i: indices of the kept
+    // points (always the first and last). O(n), one pass.
+    static std::vector<size_t> lttb(const std::vector<double>& y, size_t threshold);
+};
+
+#endif // HTMLREPORT_HPP
@@ -0,0 +1,53 @@
+#ifndef JSONWRITER_HPP
+#define JSONWRITER_HPP
+
+#include "ReportWriter.hpp"
+#include <string>
+#include <vector>
+
+// Streaming JSON serializer: values go straight to the ReportWriter buffer
+// and only one bit of state per open container is kept, so output size is
+// unbounded while memory stays constant. No DOM is built.
+//
+//   json.beginObject().key("sharpe").value(1.23).endObject().endRecord();
+//
+// endRecord() terminates a top-level value with '\n' (NDJSON).
+// scriptSafe also writes '<' as \u003c, for JSON inlined in an HTML <script>
+// where "</script>" inside a string would otherwise end the element.
+class JsonWriter {
+public:
+    explicit JsonWriter(ReportWriter& out, bool scriptSafe = false)
+        : out(out), afterKey(false), scriptSafe(scriptSafe) {}
+    
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+    JsonWriter& key(const char* name);
+    
+    // Doubles use the shortest round-trip form; NaN and infinities become null
+    JsonWriter& value(double v);
+    JsonWriter& value(long long v);
+    JsonWriter& value(int v) { return value(static_cast<long long>(v)); }
+    JsonWriter& value(size_t v) { return value(static_cast<long long>(v)); }
+    JsonWriter& value(bool v);
+    JsonWriter& value(const char* s);
+    JsonWriter& value(const std::string& s);
+    JsonWriter& null();
+    
+    // Close a top-level value with a newline (one NDJSON record)
+    JsonWriter& endRecord();
+    
+    size_t depth() const { return hasElements.size(); }
+
+private:
+    ReportWriter& out;
+    std::vector<bool> hasElements;   // Per open container: comma needed before next element
+    bool afterKey;
+    bool scriptSafe;
+    
+    void separator();
+    void string(const char* s, size_t n);
+};
+
+#endif // JSONWRITER_HPP
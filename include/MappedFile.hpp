@@ -0,0 +1,65 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <string>
+#include <cstddef>
+#include <vector>
+
+// Read-only view of a whole file. Uses mmap on POSIX so only the pages that
+// are touched get loaded; falls back to reading the file on other platforms.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    const char* data() const { return base; }
+    size_t size() const { return length; }
+    
+    // Typed pointer into the file (caller guarantees bounds and alignment)
+    template <typename T>
+    const T* at(size_t offset) const { return reinterpret_cast<const T*>(base + offset); }
+
+private:
+    const char* base;
+    size_t length;
+    std::vector<char> fallback;
+};
+
+// Writable, pre-sized shared mapping of a new file. The size is reserved on
+// disk when the file is created (throws if it does not fit), so later stores
+// cannot fault on a full disk. Stores go straight to the page cache and the
+// kernel writes them back, so the process never holds more than the pages it
+// is touching; release() drops finished ranges from the working set. Falls
+// back to an in-memory buffer written on close elsewhere.
+class MappedOutputFile {
+public:
+    MappedOutputFile(const std::string& filename, size_t size);
+    ~MappedOutputFile();
+    
+    MappedOutputFile(const MappedOutputFile&) = delete;
+    MappedOutputFile& operator=(const MappedOutputFile&) = delete;
+    
+    char* data() { return base; }
+    size_t size() const { return length; }
+    
+    template <typename T>
+    T* at(size_t offset) { return reinterpret_cast<T*>(base + offset); }
+    
+    // Start write-back of [offset, offset + n) and unmap its whole pages from
+    // this process; the contents stay in the file
+    void release(size_t offset, size_t n);
+    
+    // Block until everything written so far is on disk
+    void sync();
+
+private:
+    std::string path;
+    char* base;
+    size_t length;
+    std::vector<char> fallback;
+};
+
+#endif // MAPPEDFILE_HPP
@@ -0,0 +1,35 @@
+#ifndef METRICSSERVER_HPP
+#define METRICSSERVER_HPP
+
+#include <thread>
+#include <atomic>
+
+// Plain HTTP endpoint on 127.0.0.1 serving RuntimeMetrics::exposition() at
+// /metrics, for Prometheus or curl. One background thread answers one
+// connection at a time; a scrape only reads the metric shards and never
+// blocks the engine threads. Throws std::runtime_error if it cannot listen.
+class MetricsServer {
+public:
+    // Port 0 picks a free port (see port())
+    explicit MetricsServer(int port);
+    ~MetricsServer();
+    
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+    
+    int port() const { return boundPort; }
+    
+    // Stop accepting and join the server thread (also done by the destructor)
+    void stop();
+
+private:
+    int listenFd;
+    int boundPort;
+    std::atomic<bool> stopping;
+    std::thread worker;
+    
+    void serve();
+    void answer(int client);
+};
+
+#endif // METRICSSERVER_HPP
@@ -0,0 +1,59 @@
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+#include <string>
+#include <cstdint>
+
+// Hardware events read around a profiled scope
+enum PerfEvent {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCHES,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_LOADS,
+    PERF_L1D_LOAD_MISSES,
+    PERF_LLC_LOADS,
+    PERF_LLC_LOAD_MISSES,
+    NUM_PERF_EVENTS
+};
+
+// Counter values of the calling thread, scaled for multiplexing. An event the
+// kernel could not open (or never scheduled) has its bit clear in validMask.
+struct PerfCounts {
+    uint64_t value[NUM_PERF_EVENTS];
+    uint32_t validMask;
+    
+    PerfCounts() : value{}, validMask(0) {}
+    
+    bool has(PerfEvent e) const { return (validMask >> e) & 1u; }
+    
+    PerfCounts operator-(const PerfCounts& start) const;
+    PerfCounts& operator+=(const PerfCounts& other);
+    
+    // Derived ratios; NaN when an input event is missing or zero
+    double ipc() const;
+    double l1MissRate() const;
+    double llcMissRate() const;
+    double branchMissRate() const;
+};
+
+// Thin wrapper over Linux perf_event_open. Each thread lazily opens one
+// user-space counter per event on itself; a scope is measured by reading
+// before and after (one read syscall per event, a few microseconds). Where
+// the PMU is hidden (containers, most VMs, perf_event_paranoid > 2, other
+// platforms) nothing opens and every read comes back empty.
+class PerfCounters {
+public:
+    // True if the calling thread has at least cycles and instructions
+    static bool available();
+    
+    // Why available() is false, e.g. "no hardware PMU exposed"
+    static std::string unavailableReason();
+    
+    // Running totals of the calling thread's counters
+    static PerfCounts read();
+    
+    static const char* eventName(PerfEvent e);
+};
+
+#endif // PERFCOUNTERS_HPP
@@ -0,0 +1,68 @@
+#ifndef PORTFOLIOOPTIMIZER_HPP
+#define PORTFOLIOOPTIMIZER_HPP
+
+#include <vector>
+#include <cstddef>
+
+// Weight bounds applied to every sleeve; weights always sum to 1
+struct PortfolioConstraints {
+    double minWeight = 0.0;
+    double maxWeight = 1.0;
+    int maxIterations = 2000;
+    double tolerance = 1e-10;
+};
+
+// Optimizer output, annualized from per-bar statistics
+struct PortfolioWeights {
+    std::vector<double> weights;
+    double expectedReturn;   // Annualized, %
+    double volatility;       // Annualized, %
+    double sharpeRatio;
+    double riskSpread;       // Largest minus smallest share of variance per sleeve, %
+    int iterations;
+};
+
+class PortfolioOptimizer {
+public:
+    // Each stream is the per-bar return series of one strategy run; all must have equal length
+    explicit PortfolioOptimizer(const std::vector<std::vector<double>>& returnStreams);
+    
+    // Minimum variance - projected accelerated gradient descent
+    PortfolioWeights minimumVariance(const PortfolioConstraints& c = PortfolioConstraints()) const;
+    
+    // Equal risk contribution - cyclical coordinate descent. Sleeves held at a
+    // weight bound take whatever risk that weight carries, the others share the
+    // rest equally; riskSpread shows how far the result is from exact parity.
+    PortfolioWeights riskParity(const PortfolioConstraints& c = PortfolioConstraints()) const;
+    
+    // Maximum Sharpe ratio - projected gradient ascent with backtracking
+    PortfolioWeights maxSharpe(const PortfolioConstraints& c = PortfolioConstraints()) const;
+    
+    size_t numAssets() const { return n; }
+    const std::vector<double>& meanReturns() const { return mean; }
+    
+    // Row-major n x n sample covariance
+    const std::vector<double>& covariance() const { return cov; }
+
+private:
+    size_t n;
+    size_t bars;
+    std::vector<double> mean;
+    std::vector<double> cov;
+    
+    // Blocked X'X over the demeaned bar-major return matrix
+    void buildCovariance(const std::vector<std::vector<double>>& returnStreams);
+    
+    // y = cov * w
+    void multiply(const std::vector<double>& w, std::vector<double>& y) const;
+    
+    // Largest eigenvalue of cov by power iteration (gradient step size)
+    double largestEigenvalue() const;
+    
+    // Euclidean projection onto {sum w = 1, minWeight <= w <= maxWeight}
+    static void project(std::vector<double>& w, const PortfolioConstraints& c);
+    
+    PortfolioWeights summarize(const std::vector<double>& w, int iterations) const;
+};
+
+#endif // PORTFOLIOOPTIMIZER_HPP
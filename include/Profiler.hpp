@@ -0,0 +1,132 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include "Tracer.hpp"
+#include "PerfCounters.hpp"
+#include "AllocTracker.hpp"
+
+// Build with -DBACKTESTER_PROFILING=0 to compile every timer out
+#ifndef BACKTESTER_PROFILING
+#define BACKTESTER_PROFILING 1
+#endif
+
+// Pipeline stages timed by --profile
+enum ProfileStage {
+    STAGE_PARSE,
+    STAGE_INDICATORS,
+    STAGE_LOOP,
+    STAGE_METRICS,
+    STAGE_EXPORT,
+    NUM_PROFILE_STAGES
+};
+
+// Aggregate of every timed scope of one stage
+struct StageStats {
+    uint64_t calls;
+    uint64_t totalNs;
+    uint64_t items;       // Bars processed (0 where not meaningful)
+    uint64_t maxNs;
+    uint64_t minNs;
+    double p50Ns;         // Estimated from the histogram (~12% resolution)
+    double p99Ns;
+    PerfCounts counters;  // Summed over scopes when hardware counters ran
+};
+
+// Process-wide stage aggregates. Each stage keeps relaxed atomic counters and
+// a log-linear histogram of scope durations (4 buckets per power of two), so threads (universe runs, the async
+// writer) record without locks. Timers cost one relaxed load when profiling
+// is compiled in but not enabled.
+class Profiler {
+public:
+    static const int HISTOGRAM_BUCKETS = 256;
+
+    static void enable(bool on);
+    static bool enabled();
+
+    // Also read hardware counters around every stage scope (see PerfCounters)
+    static void enableCounters(bool on);
+    static bool countersEnabled();
+
+    static void record(ProfileStage stage, uint64_t ns, uint64_t items,
+                       const PerfCounts* counters = nullptr);
+    static StageStats stats(ProfileStage stage);
+    static void reset();
+
+    static const char* stageName(ProfileStage stage);
+
+    // Per-stage table, counter and allocation tables when those ran, a
+    // one-line share summary and peak RSS; wallSeconds is the whole run,
+    // stages may overlap it (the export thread)
+    static void printReport(double wallSeconds);
+};
+
+// RAII stage timer on steady_clock; stop() ends it early. Under --trace the
+// same scope also becomes a span named after the stage.
+class ScopedTimer {
+public:
+    explicit ScopedTimer(ProfileStage stage, uint64_t items = 0)
+        : stage(stage), items(items), active(Profiler::enabled()), traced(Tracer::enabled()),
+          counting(active && Profiler::countersEnabled()) {
+        if (traced) Tracer::begin(Profiler::stageName(stage));
+        if (counting) startCounts = PerfCounters::read();
+        if (active) {
+            allocPrevious = AllocTracker::enterStage(stage);
+            start = std::chrono::steady_clock::now();
+        }
+    }
+    ~ScopedTimer() { stop(); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    void setItems(uint64_t n) { items = n; }
+
+    void stop() {
+        if (traced) {
+            traced = false;
+            Tracer::end(Profiler::stageName(stage));
+        }
+        if (!active) return;
+        active = false;
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        AllocTracker::leaveStage(allocPrevious);
+        if (counting) {
+            PerfCounts delta = PerfCounters::read() - startCounts;
+            Profiler::record(stage, static_cast<uint64_t>(ns), items, &delta);
+        } else {
+            Profiler::record(stage, static_cast<uint64_t>(ns), items);
+        }
+    }
+
+private:
+    ProfileStage stage;
+    uint64_t items;
+    bool active;
+    bool traced;
+    bool counting;
+    int allocPrevious;
+    std::chrono::steady_clock::time_point start;
+    PerfCounts startCounts;
+};
+
+// PROFILE_SCOPE times the rest of the enclosing block; PROFILE_TIMER names a
+// timer so PROFILE_ITEMS / PROFILE_STOP can reach it. All vanish when disabled.
+#if BACKTESTER_PROFILING
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(stage, items) ScopedTimer PROFILE_CONCAT(profileScope, __LINE__)(stage, items)
+#define PROFILE_TIMER(var, stage, items) ScopedTimer var(stage, items)
+#define PROFILE_ITEMS(var, n) var.setItems(n)
+#define PROFILE_STOP(var) var.stop()
+#else
+#define PROFILE_SCOPE(stage, items) do {} while (0)
+#define PROFILE_TIMER(var, stage, items) do {} while (0)
+#define PROFILE_ITEMS(var, n) do {} while (0)
+#define PROFILE_STOP(var) do {} while (0)
+#endif
+
+#endif // PROFILER_HPP
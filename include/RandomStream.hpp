@@ -0,0 +1,54 @@
+#ifndef RANDOMSTREAM_HPP
+#define RANDOMSTREAM_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+// Reserved stream ids so each stochastic subsystem draws from its own sequence
+enum RandomStreamId : uint32_t {
+    STREAM_SYNTHETIC_PRICES = 1,
+    STREAM_BOOTSTRAP = 2,
+    STREAM_PARAMETER_SEARCH = 3,
+    STREAM_TEST_DATA = 4
+};
+
+// Counter-based generator (Philox4x32-10, Salmon et al. 2011).
+// Draw i of stream (seed, job, stream) is a pure function of i, so results are
+// identical whatever thread or call pattern produced them. The 128-bit counter
+// is (block index, stream id, job id); the 64-bit seed is the key.
+class RandomStream {
+public:
+    RandomStream(uint64_t seed, uint32_t jobId, uint32_t streamId);
+    
+    // Batch generation - uniforms in [0, 1)
+    void uniform(double* out, size_t count);
+    
+    // Batch generation - standard normals (Box-Muller on the same draw positions)
+    void normal(double* out, size_t count);
+    
+    // Single draws
+    double nextUniform();
+    double nextNormal();
+    
+    // Draw index of the next value; seek makes any position directly addressable
+    uint64_t position() const { return pos; }
+    void seek(uint64_t drawIndex) { pos = drawIndex; }
+    
+    // Raw Philox4x32-10 block function
+    static void philox(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]);
+
+private:
+    uint32_t key[2];
+    uint32_t job;
+    uint32_t stream;
+    uint64_t pos;
+    
+    // Philox on consecutive block counters, 4 words per block
+    void blocks(uint64_t first, size_t count, uint32_t* out) const;
+    
+    // Shared driver: each block yields two 53-bit uniforms (or one Box-Muller pair)
+    template <bool Normal>
+    void generate(double* out, size_t count);
+};
+
+#endif // RANDOMSTREAM_HPP
@@ -0,0 +1,30 @@
+#ifndef REGIMEDETECTOR_HPP
+#define REGIMEDETECTOR_HPP
+
+#include <vector>
+
+// Market regime labels: volatility level x trend state
+enum Regime {
+    REGIME_LOWVOL_CHOP = 0,
+    REGIME_LOWVOL_TREND = 1,
+    REGIME_HIGHVOL_CHOP = 2,
+    REGIME_HIGHVOL_TREND = 3,
+    NUM_REGIMES = 4
+};
+
+class RegimeDetector {
+public:
+    // Label every bar in a single pass over the closes.
+    // Volatility: rolling stddev of log returns, "high" when above the sample median.
+    // Trend: Kaufman efficiency ratio |net move| / path length, "trend" when above threshold.
+    // Bars before the warm-up window are labelled from the first complete window.
+    static std::vector<int> label(const std::vector<double>& closes,
+                                  int volPeriod = 20,
+                                  int trendPeriod = 50,
+                                  double trendThreshold = 0.3);
+
+    // Human-readable regime name
+    static const char* name(int regime);
+};
+
+#endif // REGIMEDETECTOR_HPP
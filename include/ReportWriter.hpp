@@ -0,0 +1,63 @@
+#ifndef REPORTWRITER_HPP
+#define REPORTWRITER_HPP
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+// Buffered text writer for reports. Numbers are formatted with std::to_chars
+// straight into one reusable buffer that is flushed in large writes.
+// fixed(v, p) produces the same characters as `std::fixed << setprecision(p)`.
+// The filename "-" writes to stdout. Write errors are sticky: once a write,
+// flush or close fails, ok() stays false.
+class ReportWriter {
+public:
+    static const size_t DEFAULT_BUFFER = 1 << 20;
+    
+    explicit ReportWriter(const std::string& filename, size_t bufferSize = DEFAULT_BUFFER);
+    ~ReportWriter();
+    
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+    
+    bool isOpen() const { return file != nullptr; }
+    
+    ReportWriter& text(const char* s, size_t n);
+    ReportWriter& text(const char* s);
+    ReportWriter& text(const std::string& s) { return text(s.data(), s.size()); }
+    ReportWriter& put(char c);
+    
+    // Raw bytes (binary outputs)
+    ReportWriter& bytes(const void* p, size_t n) { return text(static_cast<const char*>(p), n); }
+    
+    // Fixed-point with the given number of decimals
+    ReportWriter& fixed(double value, int precision);
+    
+    // Shortest representation that round-trips
+    ReportWriter& shortest(double value);
+    ReportWriter& integer(long long value);
+    
+    // Write the buffer out; also called on destruction
+    void flush();
+    
+    // Flush and close the file (stdout is only flushed); true if every
+    // write since opening succeeded. Later writes are dropped.
+    bool close();
+    
+    // Opened and nothing has failed so far
+    bool ok() const { return !failed; }
+
+private:
+    std::FILE* file;
+    bool ownsFile;
+    bool failed;
+    std::vector<char> buffer;
+    size_t used;
+    
+    // Make room for n more bytes
+    void reserve(size_t n) {
+        if (used + n > buffer.size()) flush();
+    }
+};
+
+#endif // REPORTWRITER_HPP
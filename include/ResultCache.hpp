@@ -0,0 +1,66 @@
+#ifndef RESULTCACHE_HPP
+#define RESULTCACHE_HPP
+
+#include "types.hpp"
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Mixed into every cache key; bump whenever an engine change can alter results
+const char ENGINE_VERSION[] = "1";
+
+// Identity of one run: what was simulated, on which bytes, by which engine
+struct CacheKey {
+    std::string id;          // 16 hex digits, names the cache entry
+    std::string dataFile;    // Informational; the checksum is what's keyed
+    uint64_t dataChecksum;
+    uint64_t dataBytes;
+    std::string params;      // Canonical parameter string (exact doubles)
+};
+
+// Content-addressed store of finished runs. Each entry is a .btr result
+// (objects/<id>.btr, with the per-bar series) plus a text manifest
+// (manifests/<id>.txt) describing the inputs. Entries are written to a
+// temporary name and renamed, so concurrent runs never read a partial file.
+// Lifetime hit/miss counters live in <dir>/stats.
+class ResultCache {
+public:
+    explicit ResultCache(const std::string& directory);
+    ~ResultCache();
+    
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+    
+    // Hash the data file and combine it with the configuration and ENGINE_VERSION
+    static CacheKey makeKey(const std::string& dataFile, const BacktestConfig& config);
+    
+    // Stored result for key, if any; counts a hit or a miss.
+    // Unreadable entries, and entries whose stored parameters differ from
+    // key.params, are dropped and count as misses.
+    bool load(const CacheKey& key, BacktestResult& result);
+    
+    // Add a result (should carry its series so every export can be served)
+    bool store(const CacheKey& key, const BacktestResult& result);
+    
+    // Lifetime counters including this process
+    uint64_t hits() const { return totalHits; }
+    uint64_t misses() const { return totalMisses; }
+    
+    // Write the counters back (also done by the destructor)
+    void saveStats();
+    
+    static uint64_t checksum(const char* data, size_t n, uint64_t seed = 0);
+    static std::string canonicalParams(const BacktestConfig& config);
+
+private:
+    std::string dir;
+    uint64_t totalHits;
+    uint64_t totalMisses;
+    uint64_t newHits;      // This process; added to the file on save
+    uint64_t newMisses;
+    
+    std::string objectPath(const CacheKey& key) const;
+    std::string manifestPath(const CacheKey& key) const;
+};
+
+#endif // RESULTCACHE_HPP
@@ -0,0 +1,35 @@
+#ifndef RESULTEXPORT_HPP
+#define RESULTEXPORT_HPP
+
+#include "types.hpp"
+#include "JsonWriter.hpp"
+#include <string>
+#include <vector>
+
+class ResultExport {
+public:
+    // Human-readable summary + trade log (the results.csv layout)
+    static bool writeCSV(const std::string& filename,
+                         double initialCapital,
+                         double finalValue,
+                         const PerformanceMetrics& metrics,
+                         const std::vector<Trade>& trades);
+    static bool writeCSV(const std::string& filename, const BacktestResult& result);
+    
+    // Binary layout described in BinaryResultFormat.hpp
+    static bool writeBinary(const std::string& filename, const BacktestResult& result);
+    
+    // One JSON document: config, summary metrics and the trade log
+    static bool writeJSON(const std::string& filename, const BacktestResult& result);
+    
+    // Emit "config", "final_value", "metrics" (and "trades") into an open object;
+    // shared by the JSON document and NDJSON sweep records
+    static void jsonFields(JsonWriter& json, const BacktestResult& result, bool includeTrades);
+    static void jsonConfig(JsonWriter& json, const BacktestConfig& config);
+    static void jsonMetrics(JsonWriter& json, const PerformanceMetrics& metrics);
+    
+    // Create the output's directory if it doesn't exist (one level, like results/)
+    static void ensureParentDirectory(const std::string& filename);
+};
+
+#endif // RESULTEXPORT_HPP
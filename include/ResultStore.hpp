@@ -0,0 +1,94 @@
+#ifndef RESULTSTORE_HPP
+#define RESULTSTORE_HPP
+
+#include "types.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Stored fields; every column is an 8-byte double
+enum ResultColumn {
+    COL_SHORT_MA,
+    COL_LONG_MA,
+    COL_FLAGS,
+    COL_STOP_LOSS,
+    COL_TAKE_PROFIT,
+    COL_COMMISSION,
+    COL_SLIPPAGE,
+    COL_INITIAL_CAPITAL,
+    COL_TOTAL_RETURN,
+    COL_CAGR,
+    COL_MAX_DRAWDOWN,
+    COL_SHARPE,
+    COL_NUM_TRADES,
+    COL_WINNING_TRADES,
+    COL_WIN_RATE,
+    COL_AVG_WIN,
+    COL_AVG_LOSS,
+    COL_PROFIT_FACTOR,
+    NUM_RESULT_COLUMNS
+};
+
+// Inclusive range predicate on one column
+struct ResultFilter {
+    ResultColumn column;
+    double minValue;
+    double maxValue;
+};
+
+// One stored run, decoded
+struct StoredResult {
+    uint64_t id;
+    BacktestConfig config;
+    PerformanceMetrics metrics;
+};
+
+// Append-only columnar store for sweep results.
+// Records are grouped in fixed-size blocks of BLOCK_ROWS; inside a block each
+// column is contiguous (PAX layout), so a query touches only the pages of the
+// columns it reads. Sorted indices live next to the store as
+// <path>.<column>.idx and are used by topK() while they are up to date.
+class ResultStore {
+public:
+    static const uint32_t BLOCK_ROWS = 4096;
+    
+    // Opens an existing store or creates an empty one
+    explicit ResultStore(const std::string& path);
+    ~ResultStore();
+    
+    ResultStore(const ResultStore&) = delete;
+    ResultStore& operator=(const ResultStore&) = delete;
+    
+    void append(const BacktestConfig& config, const PerformanceMetrics& metrics);
+    
+    // Write buffered records and the record count to disk
+    void flush();
+    
+    uint64_t size() const { return count; }
+    
+    // Sorted (descending) record ids for one column
+    void buildIndex(ResultColumn column);
+    bool hasFreshIndex(ResultColumn column) const;
+    
+    // Best k records by column (descending) that pass every filter.
+    // Walks the index when fresh, otherwise scans the mapped column with a
+    // size-k heap; a stale index is never rebuilt implicitly.
+    std::vector<StoredResult> topK(ResultColumn by, size_t k,
+                                   const std::vector<ResultFilter>& filters);
+    
+    static const char* columnName(ResultColumn column);
+    static bool columnFromName(const std::string& name, ResultColumn& column);
+
+private:
+    std::string path;
+    uint64_t count;              // Records including buffered ones
+    bool dirty;
+    std::vector<double> block;   // Current partial block, column-major
+    
+    std::string indexPath(ResultColumn column) const;
+    
+    // Write the buffered block into its slot and refresh the header
+    void writeBlock(uint64_t blockIndex);
+};
+
+#endif // RESULTSTORE_HPP
@@ -0,0 +1,40 @@
+#ifndef RUNTIMEMETRICS_HPP
+#define RUNTIMEMETRICS_HPP
+
+#include <string>
+#include <cstdint>
+
+enum RuntimeMetric {
+    METRIC_BARS,               // Bars simulated by Backtester::run
+    METRIC_BACKTESTS,          // Completed Backtester::run calls
+    METRIC_REPRICES,           // Cost-sweep reprices of recorded fills
+    METRIC_CACHE_HITS,
+    METRIC_CACHE_MISSES,
+    METRIC_SYMBOLS_QUEUED,     // Universe files handed to the workers
+    METRIC_SYMBOLS_DONE,
+    METRIC_EXPORTS_QUEUED,     // Jobs submitted to AsyncResultWriter
+    METRIC_EXPORTS_DONE,       // ... written or failed
+    NUM_RUNTIME_METRICS
+};
+
+// Process-wide progress counters behind --metrics-port. Every thread adds to
+// its own cache-line-aligned shard (single writer, so a relaxed load and
+// store, no locked instruction and no sharing); readers sum the shards, which
+// outlive their threads. Queue depths are derived as queued minus done, so
+// the hot paths only ever increment.
+class RuntimeMetrics {
+public:
+    static void add(RuntimeMetric metric, uint64_t n = 1);
+    
+    // Sum over every shard; exact once the writing threads have joined
+    static uint64_t total(RuntimeMetric metric);
+    
+    // Prometheus text exposition format (version 0.0.4). Stateless: rates
+    // come from rate() over the monotonic _total counters.
+    static std::string exposition();
+    
+    // Current resident set from /proc/self/statm; 0 where unavailable
+    static uint64_t residentBytes();
+};
+
+#endif // RUNTIMEMETRICS_HPP
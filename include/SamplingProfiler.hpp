@@ -0,0 +1,36 @@
+#ifndef SAMPLINGPROFILER_HPP
+#define SAMPLINGPROFILER_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// In-process CPU sampler for --sample-profile. A SIGPROF interval timer
+// interrupts whichever thread is burning CPU; the handler captures its stack
+// with backtrace() and counts it in a fixed table of distinct stacks
+// (claimed with compare-exchange, no locks and no allocation in the handler),
+// so memory stays flat however long the run. Blocked threads use no CPU time
+// and are not sampled. At exit the table is symbolized and written in the
+// collapsed-stack format of flamegraph.pl, inferno and speedscope.
+class SamplingProfiler {
+public:
+    static const int DEFAULT_HZ = 99;        // Off 100 Hz so samples do not lock step with periodic work
+    static const size_t MAX_DEPTH = 64;      // Deeper stacks keep their innermost frames
+    static const size_t MAX_STACKS = 1 << 14;
+    
+    // Install the handler and start the timer; false (see unavailableReason)
+    // where interval timers or stack capture are not supported
+    static bool start(int hz = DEFAULT_HZ);
+    static void stop();
+    static bool running();
+    static std::string unavailableReason();
+    
+    // One "root;caller;...;leaf count" line per distinct stack; call after stop()
+    static bool writeCollapsed(const std::string& filename);
+    
+    static uint64_t sampleCount();
+    static uint64_t droppedSamples();   // Stack table full or stack not captured
+    static size_t stackCount();
+};
+
+#endif // SAMPLINGPROFILER_HPP
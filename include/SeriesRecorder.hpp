@@ -0,0 +1,97 @@
+#ifndef SERIESRECORDER_HPP
+#define SERIESRECORDER_HPP
+
+#include "types.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+class MappedOutputFile;
+
+// Mapped series file (allocateMapped): header, numColumns names of
+// SERIES_NAME_CHARS bytes, then from dataOffset one numBars-long double array
+// per recorded column
+const char SERIES_FILE_MAGIC[8] = {'B', 'T', 'S', 'E', 'R', 'I', 'E', 'S'};
+const uint32_t SERIES_FILE_VERSION = 1;
+const size_t SERIES_NAME_CHARS = 32;
+
+struct SeriesFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numColumns;
+    uint64_t numBars;
+    uint64_t dataOffset;
+    char reserved[32];
+};
+static_assert(sizeof(SeriesFileHeader) == 64, "series header must stay 64 bytes");
+
+// Columnar per-bar time series. Recorded columns live in one block allocated
+// up front (huge-page backed where available, to keep page faults off the
+// bar loop) so recording is a plain store; precomputed series (indicators)
+// are adopted by move instead of copied.
+//
+// allocateMapped() puts the recorded columns in a pre-sized shared file
+// mapping instead: the OS writes pages back and endBar() periodically drops
+// finished ones, so resident memory stays bounded for any series length.
+class SeriesRecorder {
+public:
+    // Mapped mode releases written pages every this many bars
+    static const size_t RELEASE_BARS = 1 << 16;
+    
+    SeriesRecorder() : bars(0), recorded(0), dataOffset(0), releasedBars(0), nextRelease(SIZE_MAX) {}
+    
+    // Allocate numBars rows for each named column; adopted columns follow
+    void allocate(size_t numBars, const std::vector<std::string>& columnNames);
+    
+    // Same, with the recorded columns living in a new file at path
+    void allocateMapped(const std::string& path, size_t numBars,
+                        const std::vector<std::string>& columnNames);
+    
+    // Take ownership of a full-length precomputed series as a new column
+    void adopt(const std::string& columnName, std::vector<double>&& values);
+    
+    bool empty() const { return names.empty(); }
+    size_t numBars() const { return bars; }
+    size_t numColumns() const { return names.size(); }
+    const std::string& name(size_t column) const { return names[column]; }
+    
+    double* column(size_t c) {
+        return c < recorded ? block.get() + c * bars : adopted[c - recorded].data();
+    }
+    const double* column(size_t c) const {
+        return c < recorded ? block.get() + c * bars : adopted[c - recorded].data();
+    }
+    
+    // Recorded columns only
+    void set(size_t c, size_t bar, double value) { block.get()[c * bars + bar] = value; }
+    
+    // Bars before `bar` are final (bars are recorded in order)
+    void endBar(size_t bar) {
+        if (bar >= nextRelease) releaseBefore(bar);
+    }
+    
+    bool isMapped() const { return mapped != nullptr; }
+    
+    // Stream rows as CSV: Date,<column>,... with fixed decimals
+    bool writeCSV(const std::string& filename,
+                  const std::vector<OHLCV>& bars,
+                  int precision = 6) const;
+
+private:
+    size_t bars;
+    size_t recorded;
+    std::vector<std::string> names;
+    std::shared_ptr<double> block;
+    std::vector<std::vector<double>> adopted;
+    
+    std::shared_ptr<MappedOutputFile> mapped;
+    size_t dataOffset;
+    size_t releasedBars;
+    size_t nextRelease;
+    
+    void releaseBefore(size_t bar);
+};
+
+#endif // SERIESRECORDER_HPP
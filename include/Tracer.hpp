@@ -0,0 +1,65 @@
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// One begin/end record; names must be string literals (or otherwise outlive
+// the trace), per-event detail such as a symbol is copied and truncated
+struct TraceEvent {
+    uint64_t ts;          // ns since Tracer::enable
+    const char* name;
+    char phase;           // 'B' or 'E'
+    char detail[23];
+};
+
+// Timeline recorder for --trace. Every thread writes into its own ring buffer
+// (single producer, no locks after the thread's first event); when a ring is
+// full the oldest events are overwritten and counted as dropped. At exit the
+// rings are dumped in the Chrome trace event format, which chrome://tracing
+// and ui.perfetto.dev open directly.
+class Tracer {
+public:
+    static const size_t DEFAULT_EVENTS_PER_THREAD = 1 << 15;
+    
+    // Call before starting worker threads; capacity is rounded up to a power of two
+    static void enable(size_t eventsPerThread = DEFAULT_EVENTS_PER_THREAD);
+    static bool enabled();
+    
+    static void begin(const char* name, const char* detail = nullptr);
+    static void end(const char* name);
+    
+    // Label for the calling thread's track (e.g. "worker 3")
+    static void setThreadName(const std::string& name);
+    
+    // Write every ring as {"traceEvents": [...]}; call after workers joined
+    static bool writeChromeTrace(const std::string& filename);
+    
+    static uint64_t eventCount();
+    static uint64_t droppedEvents();
+};
+
+// RAII span on the calling thread's track
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, const char* detail = nullptr)
+        : name(Tracer::enabled() ? name : nullptr) {
+        if (this->name) Tracer::begin(name, detail);
+    }
+    ~TraceScope() {
+        if (name) Tracer::end(name);
+    }
+    
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(...) TraceScope TRACE_CONCAT(traceScope, __LINE__)(__VA_ARGS__)
+
+#endif // TRACER_HPP
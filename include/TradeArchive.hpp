@@ -0,0 +1,128 @@
+#ifndef TRADEARCHIVE_HPP
+#define TRADEARCHIVE_HPP
+
+#include "types.hpp"
+#include "MappedFile.hpp"
+#include "ReportWriter.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+// Compact archive of trade logs, one log per (symbol, run).
+//
+// Values are kept at the precision of the CSV trade log (prices and P&L in
+// cents, shares in 1e-4, returns in basis points; NaN/inf/-0 as flags), so
+// decoding reproduces exportResults' trade lines exactly. Per log, each field
+// is a column of small integers:
+//   - bar indices delta-coded (entry vs previous exit, exit vs entry); dates
+//     as the residual against ~7 calendar days per 5 bars
+//   - prices delta-coded the same way
+//   - shares, costs (implied P&L minus P&L) and return as residuals against
+//     what the previous trade predicts (same sizing ratio, same cost rate)
+//   - exit reason and special values as bit flags
+// A column stores its first value as a varint, then frames of 128 values
+// bit-packed at the frame's width above its minimum (frame of reference).
+// Symbols go into a dictionary in the footer.
+//
+// File: "BTARCH01" | log blocks | symbol dictionary | log index | trailer
+const char TRADE_ARCHIVE_MAGIC[8] = {'B', 'T', 'A', 'R', 'C', 'H', '0', '1'};
+
+struct TradeArchiveTrailer {
+    uint64_t dictionaryOffset;
+    uint64_t indexOffset;
+    uint64_t numLogs;
+    char magic[8];
+};
+
+// Decoded log in columns; toTrades() builds the Trade structs
+struct ArchivedLog {
+    std::vector<int32_t> entryDay;      // Days since 1970-01-01
+    std::vector<int32_t> exitDay;
+    std::vector<uint64_t> entryIndex;
+    std::vector<uint64_t> exitIndex;
+    std::vector<int64_t> entryCents;
+    std::vector<int64_t> exitCents;
+    std::vector<int64_t> shares;        // 1e-4 shares
+    std::vector<int64_t> pnlCents;
+    std::vector<int64_t> returnBps;     // 0.01 %
+    std::vector<uint32_t> flags;        // Exit reason (2 bits), special value codes
+    
+    size_t size() const { return entryDay.size(); }
+    ExitReason reason(size_t i) const { return static_cast<ExitReason>(flags[i] & 3); }
+    
+    // Field values as doubles (special values restored)
+    double entryPrice(size_t i) const;
+    double exitPrice(size_t i) const;
+    double shareCount(size_t i) const;
+    double pnl(size_t i) const;
+    double returnPct(size_t i) const;
+    
+    std::vector<Trade> toTrades() const;
+};
+
+class TradeArchiveWriter {
+public:
+    explicit TradeArchiveWriter(const std::string& filename);
+    ~TradeArchiveWriter();
+    
+    TradeArchiveWriter(const TradeArchiveWriter&) = delete;
+    TradeArchiveWriter& operator=(const TradeArchiveWriter&) = delete;
+    
+    bool isOpen() const { return out.isOpen(); }
+    
+    // Append one trade log; dates must be YYYY-MM-DD
+    void add(const std::string& symbol, const std::vector<Trade>& trades);
+    
+    // Write dictionary, index and trailer (also done on destruction);
+    // false if any write failed
+    bool close();
+    
+    uint64_t bytesWritten() const { return offset; }
+
+private:
+    struct IndexEntry {
+        uint32_t symbol;
+        uint64_t numTrades;
+        uint64_t offset;
+    };
+    
+    ReportWriter out;
+    uint64_t offset;
+    bool closed;
+    std::map<std::string, uint32_t> symbolIds;
+    std::vector<std::string> symbols;
+    std::vector<IndexEntry> index;
+    std::vector<uint8_t> block;
+    
+    void emit(const std::vector<uint8_t>& bytes);
+};
+
+class TradeArchiveReader {
+public:
+    explicit TradeArchiveReader(const std::string& filename);
+    
+    size_t numLogs() const { return logs.size(); }
+    const std::string& symbol(size_t log) const { return symbols[logs[log].symbol]; }
+    size_t numTrades(size_t log) const { return logs[log].numTrades; }
+    
+    // Column decode; reuses out's storage across calls
+    void decode(size_t log, ArchivedLog& out) const;
+    std::vector<Trade> trades(size_t log) const;
+    
+    // Every log as CSV trade lines with a leading Symbol column
+    bool toCSV(const std::string& filename) const;
+
+private:
+    struct LogEntry {
+        uint32_t symbol;
+        uint64_t numTrades;
+        uint64_t offset;
+    };
+    
+    MappedFile file;
+    std::vector<std::string> symbols;
+    std::vector<LogEntry> logs;
+};
+
+#endif // TRADEARCHIVE_HPP
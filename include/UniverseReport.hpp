@@ -0,0 +1,66 @@
+#ifndef UNIVERSEREPORT_HPP
+#define UNIVERSEREPORT_HPP
+
+#include "types.hpp"
+#include <string>
+#include <vector>
+
+// One symbol's row in the consolidated report
+struct SymbolSummary {
+    std::string symbol;
+    std::string firstDate;
+    std::string lastDate;
+    double finalValue;
+    PerformanceMetrics metrics;
+};
+
+// Cross-sectional distribution of one metric
+struct Distribution {
+    double min;
+    double p25;
+    double median;
+    double p75;
+    double max;
+    double mean;
+    double stdDev;
+};
+
+// Aggregate of a universe run
+struct UniverseSummary {
+    std::vector<SymbolSummary> symbols;      // Sorted by symbol
+    std::vector<std::string> skipped;        // "symbol: reason"
+    
+    Distribution totalReturn;
+    Distribution cagr;
+    Distribution maxDrawdown;
+    Distribution sharpe;
+    
+    // Equal-weight portfolio, rebalanced every bar across the symbols trading that day
+    std::vector<std::string> dates;
+    std::vector<double> equity;              // Starts at 1.0
+    std::vector<int> constituents;           // Symbols contributing on each date
+    PerformanceMetrics combined;             // Return, CAGR, drawdown, Sharpe only
+};
+
+class UniverseReport {
+public:
+    // CSV files in a directory, sorted by name
+    static std::vector<std::string> listFiles(const std::string& directory);
+    
+    // Backtest every file with the same configuration on `threads` workers.
+    // Each worker folds its symbols into a private partial (per-symbol rows and
+    // per-date return sums); partials are then merged pairwise in parallel.
+    static UniverseSummary run(const std::vector<std::string>& files,
+                               const BacktestConfig& config,
+                               unsigned threads);
+    
+    // Percentiles by selection (nth_element), not a full sort; reorders values
+    static Distribution distribution(std::vector<double>& values);
+    
+    // Consolidated CSV: distributions, per-symbol table, equal-weight curve
+    static bool writeCSV(const std::string& filename, const UniverseSummary& summary);
+    
+    static void printSummary(const UniverseSummary& summary);
+};
+
+#endif // UNIVERSEREPORT_HPP
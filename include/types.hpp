@@ -1,6 +1,7 @@
 #ifndef TYPES_HPP
 #define TYPES_HPP
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -15,6 +16,14 @@ struct OHLCV {
     long long volume;
 };
 
+// Why a position was closed
+enum ExitReason {
+    EXIT_SIGNAL = 0,
+    EXIT_STOP_LOSS = 1,
+    EXIT_TAKE_PROFIT = 2,
+    EXIT_END_OF_DATA = 3
+};
+
 // Trade structure to track individual trades
 struct Trade {
     std::string entryDate;
@@ -24,6 +33,17 @@ struct Trade {
     double shares;
     double pnl;
     double returnPct;
+    size_t entryIndex;   // Bar index of the entry signal
+    size_t exitIndex;    // Bar index of the exit signal
+    ExitReason exitReason;
+};
+
+// One recorded execution; the fill sequence is independent of cost parameters
+struct Fill {
+    size_t barIndex;     // Signal bar
+    double quotePrice;   // Price before slippage
+    bool isEntry;
+    ExitReason reason;   // Exits only
 };
 
 // Performance metrics for backtesting results
@@ -61,4 +81,33 @@ struct StrategyParams {
     std::string name;
 };
 
+// Full parameter set of a single backtest run
+struct BacktestConfig {
+    int shortMA;
+    int longMA;
+    double initialCapital;
+    bool useRSI;
+    bool useEMA;
+    bool useMACD;
+    bool useBollinger;
+    double stopLoss;
+    double takeProfit;
+    double commission;
+    bool useKelly;
+    double slippage;
+};
+
+// Everything a run produces, detached from the engine (export, caching)
+struct BacktestResult {
+    BacktestConfig config;
+    double finalValue;
+    PerformanceMetrics metrics;
+    std::vector<Trade> trades;
+    
+    // Per-bar series (empty unless requested)
+    std::vector<std::string> dates;
+    std::vector<double> equity;
+    std::vector<double> position;
+};
+
 #endif // TYPES_HPP
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "../include/AllocTracker.hpp"
+#include "../include/Profiler.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#if BACKTESTER_ALLOC_TRACKING
+#include <malloc.h>
+#endif
+using namespace std;
+
+namespace {
+struct StageAllocs {
+    atomic<uint64_t> allocations{0};
+    atomic<uint64_t> bytes{0};
+    atomic<uint64_t> frees{0};
+};
+
+// Slot 0 is OTHER_STAGE, then one per ProfileStage
+StageAllocs stageAllocs[NUM_PROFILE_STAGES + 1];
+atomic<uint64_t> live{0};
+atomic<uint64_t> peakLive{0};
+
+// Plain int so reading it never allocates
+thread_local int currentStage = AllocTracker::OTHER_STAGE;
+
+#if BACKTESTER_ALLOC_TRACKING
+void onAlloc(void* p, size_t requested) {
+    if (!p) return;
+    StageAllocs& s = stageAllocs[currentStage + 1];
+    s.allocations.fetch_add(1, memory_order_relaxed);
+    s.bytes.fetch_add(requested, memory_order_relaxed);
+    uint64_t now = live.fetch_add(malloc_usable_size(p), memory_order_relaxed) + malloc_usable_size(p);
+    uint64_t prev = peakLive.load(memory_order_relaxed);
+    while (now > prev && !peakLive.compare_exchange_weak(prev, now, memory_order_relaxed)) {
+    }
+}
+
+void onFree(void* p) {
+    if (!p) return;
+    stageAllocs[currentStage + 1].frees.fetch_add(1, memory_order_relaxed);
+    live.fetch_sub(malloc_usable_size(p), memory_order_relaxed);
+}
+
+void* trackedNew(size_t n) {
+    void* p = malloc(n > 0 ? n : 1);
+    if (!p) throw bad_alloc();
+    onAlloc(p, n);
+    return p;
+}
+
+void* trackedAlignedNew(size_t n, align_val_t alignment) {
+    size_t a = static_cast<size_t>(alignment);
+    void* p = nullptr;
+    if (posix_memalign(&p, a < sizeof(void*) ? sizeof(void*) : a, n > 0 ? n : 1) != 0) {
+        throw bad_alloc();
+    }
+    onAlloc(p, n);
+    return p;
+}
+
+void trackedDelete(void* p) {
+    onFree(p);
+    free(p);
+}
+#endif
+}
+
+#if BACKTESTER_ALLOC_TRACKING
+// Replacements for every global allocation function; sized and aligned
+// deletes forward to the same path
+void* operator new(size_t n) { return trackedNew(n); }
+void* operator new[](size_t n) { return trackedNew(n); }
+void* operator new(size_t n, const nothrow_t&) noexcept {
+    try { return trackedNew(n); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t n, const nothrow_t&) noexcept {
+    try { return trackedNew(n); } catch (...) { return nullptr; }
+}
+void* operator new(size_t n, align_val_t a) { return trackedAlignedNew(n, a); }
+void* operator new[](size_t n, align_val_t a) { return trackedAlignedNew(n, a); }
+
+void operator delete(void* p) noexcept { trackedDelete(p); }
+void operator delete[](void* p) noexcept { trackedDelete(p); }
+void operator delete(void* p, size_t) noexcept { trackedDelete(p); }
+void operator delete[](void* p, size_t) noexcept { trackedDelete(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { trackedDelete(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { trackedDelete(p); }
+void operator delete(void* p, align_val_t) noexcept { trackedDelete(p); }
+void operator delete[](void* p, align_val_t) noexcept { trackedDelete(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { trackedDelete(p); }
+void operator delete[](void* p, size_t, align_val_t) noexcept { trackedDelete(p); }
+#endif
+
+bool AllocTracker::enabled() {
+    return BACKTESTER_ALLOC_TRACKING != 0;
+}
+
+int AllocTracker::enterStage(int stage) {
+    int previous = currentStage;
+    currentStage = stage;
+    return previous;
+}
+
+void AllocTracker::leaveStage(int previous) {
+    currentStage = previous;
+}
+
+AllocStats AllocTracker::stats(int stage) {
+    const StageAllocs& s = stageAllocs[stage + 1];
+    return {s.allocations.load(memory_order_relaxed),
+            s.bytes.load(memory_order_relaxed),
+            s.frees.load(memory_order_relaxed)};
+}
+
+AllocStats AllocTracker::total() {
+    AllocStats t = {0, 0, 0};
+    for (int s = OTHER_STAGE; s < NUM_PROFILE_STAGES; s++) {
+        AllocStats a = stats(s);
+        t.allocations += a.allocations;
+        t.bytes += a.bytes;
+        t.frees += a.frees;
+    }
+    return t;
+}
+
+uint64_t AllocTracker::liveBytes() {
+    return live.load(memory_order_relaxed);
+}
+
+uint64_t AllocTracker::peakLiveBytes() {
+    return peakLive.load(memory_order_relaxed);
+}
+
+uint64_t AllocTracker::peakRssBytes() {
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024;   // Linux reports KiB
+    }
+#endif
+    return 0;
+}
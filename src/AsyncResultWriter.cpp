@@ -0,0 +1,124 @@
+#include "../include/AsyncResultWriter.hpp"
+#include "../include/ResultExport.hpp"
+#include "../include/HtmlReport.hpp"
+#include "../include/Profiler.hpp"
+#include "../include/Tracer.hpp"
+#include "../include/RuntimeMetrics.hpp"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+using namespace std;
+
+AsyncResultWriter::AsyncResultWriter(size_t queueCapacity, size_t batch)
+    : capacity(queueCapacity > 0 ? queueCapacity : 1),
+      syncBatch(batch > 0 ? batch : 1),
+      closing(false), written(0), failed(0), blocked(0) {
+    worker = thread(&AsyncResultWriter::run, this);
+}
+
+AsyncResultWriter::~AsyncResultWriter() {
+    close();
+}
+
+void AsyncResultWriter::submit(ExportJob job) {
+    unique_lock<mutex> lock(mtx);
+    if (queue.size() >= capacity) {
+        blocked++;
+        TRACE_SCOPE("writer.blocked");
+        notFull.wait(lock, [this] { return queue.size() < capacity || closing; });
+    }
+    if (closing) {
+        // Late submissions after close() are written synchronously
+        lock.unlock();
+        bool ok = write(job);
+        (ok ? written : failed)++;
+        return;
+    }
+    RuntimeMetrics::add(METRIC_EXPORTS_QUEUED);
+    queue.push_back(move(job));
+    notEmpty.notify_one();
+}
+
+void AsyncResultWriter::close() {
+    {
+        lock_guard<mutex> lock(mtx);
+        if (closing && !worker.joinable()) return;
+        closing = true;
+    }
+    notEmpty.notify_all();
+    notFull.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+size_t AsyncResultWriter::queueDepth() const {
+    lock_guard<mutex> lock(mtx);
+    return queue.size();
+}
+
+void AsyncResultWriter::run() {
+    Tracer::setThreadName("result writer");
+    vector<string> unsynced;
+    
+    while (true) {
+        ExportJob job;
+        {
+            unique_lock<mutex> lock(mtx);
+            if (queue.empty()) {
+                // Idle: make everything written so far durable before sleeping
+                lock.unlock();
+                syncFiles(unsynced);
+                lock.lock();
+                notEmpty.wait(lock, [this] { return !queue.empty() || closing; });
+                if (queue.empty()) break;
+            }
+            job = move(queue.front());
+            queue.pop_front();
+        }
+        notFull.notify_one();
+        
+        bool ok = write(job);
+        if (ok) {
+            written++;
+            if (job.filename != "-") unsynced.push_back(job.filename);
+            if (unsynced.size() >= syncBatch) syncFiles(unsynced);
+        } else {
+            failed++;
+        }
+        RuntimeMetrics::add(METRIC_EXPORTS_DONE);
+    }
+    
+    syncFiles(unsynced);
+}
+
+bool AsyncResultWriter::write(const ExportJob& job) {
+    TRACE_SCOPE("write", job.filename.c_str());
+    PROFILE_SCOPE(STAGE_EXPORT, 0);
+    switch (job.format) {
+        case EXPORT_BINARY: return ResultExport::writeBinary(job.filename, job.result);
+        case EXPORT_JSON: return ResultExport::writeJSON(job.filename, job.result);
+        case EXPORT_HTML: return HtmlReport::write(job.filename, job.result);
+        default: return ResultExport::writeCSV(job.filename, job.result);
+    }
+}
+
+void AsyncResultWriter::syncFiles(vector<string>& paths) {
+#ifndef _WIN32
+    if (paths.empty()) return;
+    TRACE_SCOPE("fsync");
+    for (const auto& p : paths) {
+        // A file that cannot be made durable (EIO, ENOSPC on delayed
+        // allocation) is a failed write; devices and pipes that do not
+        // support fsync are not
+        int fd = open(p.c_str(), O_RDONLY);
+        bool ok = fd >= 0 && (fsync(fd) == 0 || errno == EINVAL || errno == EROFS);
+        if (fd >= 0 && ::close(fd) != 0) ok = false;
+        if (!ok) {
+            written--;
+            failed++;
+        }
+    }
+#endif
+    paths.clear();
+}
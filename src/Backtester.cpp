@@ -1,16 +1,13 @@
 #include "../include/Backtester.hpp"
 #include "../include/TechnicalIndicators.hpp"
+#include "../include/ResultExport.hpp"
+#include "../include/Profiler.hpp"
+#include "../include/RuntimeMetrics.hpp"
 #include <iostream>
-#include <fstream>
 #include <iomanip>
 #include <numeric>
 #include <cmath>
 #include <algorithm>
-#ifdef _WIN32
-#include <direct.h>
-#else
-#include <sys/stat.h>
-#endif
 using namespace std;
 Backtester::Backtester(const vector<OHLCV>& d,int shortMA, 
                        int longMA,
@@ -22,14 +19,33 @@ Backtester::Backtester(const vector<OHLCV>& d,int shortMA,
                        double stopLoss,
                        double takeProfit,
                        double commission,
-                       bool kelly)
+                       bool kelly,
+                       double slippage)
     : data(d), shortPeriod(shortMA), longPeriod(longMA),
       initialCapital(capital), useRSI(rsi), useEMA(ema), 
       useMACD(macd), useBollinger(bollinger),
       stopLossPercent(stopLoss), takeProfitPercent(takeProfit),
-      commissionRate(commission),
+      commissionRate(commission), slippageRate(slippage),
       currentCash(capital), currentShares(0.0), inPosition(false),
-      useKellyCriterion(kelly) {}
+      entryQuote(0.0), useKellyCriterion(kelly),
+      recordSeries(false), equityPeak(capital) {}
+
+BacktestConfig Backtester::getConfig() const {
+    BacktestConfig c;
+    c.shortMA = shortPeriod;
+    c.longMA = longPeriod;
+    c.initialCapital = initialCapital;
+    c.useRSI = useRSI;
+    c.useEMA = useEMA;
+    c.useMACD = useMACD;
+    c.useBollinger = useBollinger;
+    c.stopLoss = stopLossPercent;
+    c.takeProfit = takeProfitPercent;
+    c.commission = commissionRate;
+    c.useKelly = useKellyCriterion;
+    c.slippage = slippageRate;
+    return c;
+}
 
 void Backtester::run() {
     if (data.size() < static_cast<size_t>(longPeriod + 1)) {
@@ -37,6 +53,17 @@ void Backtester::run() {
         return;
     }
     
+    // Start from a flat book so run() can be repeated on one engine
+    trades.clear();
+    fills.clear();
+    currentCash = initialCapital;
+    currentShares = 0.0;
+    inPosition = false;
+    entryQuote = 0.0;
+    equityPeak = initialCapital;
+    
+    PROFILE_TIMER(indicatorTimer, STAGE_INDICATORS, data.size());
+    
     // Extract close prices
     vector<double> closes;
     for (const auto& bar : data) {
@@ -64,6 +91,20 @@ void Backtester::run() {
     if (useBollinger) {
         bb = TechnicalIndicators::BollingerBand(closes);
     }
+    PROFILE_STOP(indicatorTimer);
+    PROFILE_SCOPE(STAGE_LOOP, data.size());
+    
+    if (recordSeries) {
+        // Indicator columns are adopted after the loop, once they are no longer read
+        vector<string> columns = {"equity", "cash", "position", "drawdown"};
+        if (seriesPath.empty()) {
+            series.allocate(data.size(), columns);
+        } else {
+            series.allocateMapped(seriesPath, data.size(), columns);
+        }
+        equityPeak = initialCapital;
+        for (size_t i = 0; i < static_cast<size_t>(longPeriod); i++) recordBar(i, closes[i]);
+    }
     
     // Generate signals and execute trades
     for (size_t i = longPeriod; i < data.size(); i++) {
@@ -71,13 +112,15 @@ void Backtester::run() {
         if (inPosition) {
             // Stop loss check
             if (checkStopLoss(i)) {
-                exitPosition(i);
+                exitPosition(i, EXIT_STOP_LOSS);
+                if (recordSeries) recordBar(i, closes[i]);
                 continue;
             }
             
             // Take profit check
             if (checkTakeProfit(i)) {
-                exitPosition(i);
+                exitPosition(i, EXIT_TAKE_PROFIT);
+                if (recordSeries) recordBar(i, closes[i]);
                 continue;
             }
         }
@@ -117,20 +160,84 @@ void Backtester::run() {
         if (entrySignal && !inPosition) {
             enterPosition(i);
         } else if (exitSignal && inPosition) {
-            exitPosition(i);
+            exitPosition(i, EXIT_SIGNAL);
         }
+        
+        if (recordSeries) recordBar(i, closes[i]);
     }
     
     // Close any open position at the end
     if (inPosition) {
-        exitPosition(data.size() - 1);
+        exitPosition(data.size() - 1, EXIT_END_OF_DATA);
+        if (recordSeries) recordBar(data.size() - 1, closes.back());
     }
+    
+    if (recordSeries) {
+        series.adopt("short_ma", move(shortMA));
+        series.adopt("long_ma", move(longMA));
+        if (useRSI) series.adopt("rsi", move(rsi));
+        if (useMACD) {
+            series.adopt("macd", move(macdData.macd));
+            series.adopt("macd_signal", move(macdData.signal));
+            series.adopt("macd_hist", move(macdData.histogram));
+        }
+        if (useBollinger) {
+            series.adopt("bb_upper", move(bb.upper));
+            series.adopt("bb_middle", move(bb.middle));
+            series.adopt("bb_lower", move(bb.lower));
+        }
+    }
+    
+    RuntimeMetrics::add(METRIC_BARS, data.size());
+    RuntimeMetrics::add(METRIC_BACKTESTS);
+}
+
+void Backtester::recordBar(size_t idx, double close) {
+    enum { SERIES_EQUITY, SERIES_CASH, SERIES_POSITION, SERIES_DRAWDOWN };
+    
+    double equity = currentCash + currentShares * close;
+    if (equity > equityPeak) equityPeak = equity;
+    
+    series.set(SERIES_EQUITY, idx, equity);
+    series.set(SERIES_CASH, idx, currentCash);
+    series.set(SERIES_POSITION, idx, currentShares);
+    series.set(SERIES_DRAWDOWN, idx, equityPeak > 0 ? ((equityPeak - equity) / equityPeak) * 100.0 : 0.0);
+    series.endBar(idx);
+}
+
+bool Backtester::exportSeries(const string& filename) const {
+    if (series.empty()) return false;
+    return series.writeCSV(filename, data);
+}
+
+double Backtester::quotePrice(size_t idx) const {
+    return (idx + 1 < data.size() && data[idx + 1].open > 0)
+               ? data[idx + 1].open
+               : data[idx].close;
 }
 
 void Backtester::enterPosition(size_t idx) {
-    double entryPrice = (idx + 1 < data.size() && data[idx + 1].open > 0)
-                            ? data[idx + 1].open
-                            : data[idx].close;
+    Fill f;
+    f.barIndex = idx;
+    f.quotePrice = quotePrice(idx);
+    f.isEntry = true;
+    f.reason = EXIT_SIGNAL;
+    fills.push_back(f);
+    applyEntry(f);
+}
+
+void Backtester::exitPosition(size_t idx, ExitReason reason) {
+    Fill f;
+    f.barIndex = idx;
+    f.quotePrice = quotePrice(idx);
+    f.isEntry = false;
+    f.reason = reason;
+    fills.push_back(f);
+    applyExit(f);
+}
+
+void Backtester::applyEntry(const Fill& fill) {
+    double entryPrice = fill.quotePrice * (1.0 + slippageRate);
     
     // Apply commission
     double commission = currentCash * commissionRate;
@@ -145,18 +252,20 @@ void Backtester::enterPosition(size_t idx) {
     currentShares = (availableCash * positionFraction) / entryPrice;
     currentCash = 0.0;
     inPosition = true;
+    entryQuote = fill.quotePrice;
     
     Trade t;
-    t.entryDate = data[idx].date;
+    t.entryDate = data[fill.barIndex].date;
     t.entryPrice = entryPrice;
     t.shares = currentShares;
+    t.entryIndex = fill.barIndex;
+    t.exitIndex = data.size();
+    t.exitReason = EXIT_END_OF_DATA;
     trades.push_back(t);
 }
 
-void Backtester::exitPosition(size_t idx) {
-    double exitPrice = (idx + 1 < data.size() && data[idx + 1].open > 0)
-                           ? data[idx + 1].open
-                           : data[idx].close;
+void Backtester::applyExit(const Fill& fill) {
+    double exitPrice = fill.quotePrice * (1.0 - slippageRate);
     
     double grossProceeds = currentShares * exitPrice;
     double commission = grossProceeds * commissionRate;
@@ -165,18 +274,38 @@ void Backtester::exitPosition(size_t idx) {
     inPosition = false;
     
     Trade& t = trades.back();
-    t.exitDate = data[idx].date;
+    t.exitDate = data[fill.barIndex].date;
     t.exitPrice = exitPrice;
+    t.exitIndex = fill.barIndex;
+    t.exitReason = fill.reason;
     t.pnl = currentCash - (t.shares * t.entryPrice);
     t.returnPct = (t.pnl / (t.shares * t.entryPrice)) * 100.0;
 }
 
+void Backtester::reprice(double commission, double slippage) {
+    commissionRate = commission;
+    slippageRate = slippage;
+    
+    currentCash = initialCapital;
+    currentShares = 0.0;
+    inPosition = false;
+    trades.clear();
+    
+    for (const auto& f : fills) {
+        if (f.isEntry) {
+            applyEntry(f);
+        } else {
+            applyExit(f);
+        }
+    }
+    RuntimeMetrics::add(METRIC_REPRICES);
+}
+
 bool Backtester::checkStopLoss(size_t idx) const {
     if (stopLossPercent <= 0 || trades.empty()) return false;
     
     double currentPrice = data[idx].close;
-    double entryPrice = trades.back().entryPrice;
-    double pnlPercent = (currentPrice - entryPrice) / entryPrice;
+    double pnlPercent = (currentPrice - entryQuote) / entryQuote;
     
     return pnlPercent <= -stopLossPercent;
 }
@@ -185,8 +314,7 @@ bool Backtester::checkTakeProfit(size_t idx) const {
     if (takeProfitPercent <= 0 || trades.empty()) return false;
     
     double currentPrice = data[idx].close;
-    double entryPrice = trades.back().entryPrice;
-    double pnlPercent = (currentPrice - entryPrice) / entryPrice;
+    double pnlPercent = (currentPrice - entryQuote) / entryQuote;
     
     return pnlPercent >= takeProfitPercent;
 }
@@ -222,6 +350,7 @@ double Backtester::calculateKellyFraction() const {
 }
 
 PerformanceMetrics Backtester::calculateMetrics() const {
+    PROFILE_SCOPE(STAGE_METRICS, data.size());
     PerformanceMetrics m;
     m.numTrades = trades.size();
     
@@ -323,6 +452,143 @@ double Backtester::calculateSharpeRatio() const {
     return sharpe;
 }
 
+void Backtester::buildEquityCurve(vector<double>& equity, vector<double>* position) const {
+    equity.assign(data.size(), initialCapital);
+    if (position) position->assign(data.size(), 0.0);
+    
+    double cash = initialCapital;
+    double shares = 0.0;
+    size_t tradeIdx = 0;
+    bool holding = false;
+    
+    for (size_t i = 0; i < data.size(); i++) {
+        if (!holding && tradeIdx < trades.size() && trades[tradeIdx].entryIndex == i) {
+            holding = true;
+            shares = trades[tradeIdx].shares;
+        }
+        
+        if (holding && trades[tradeIdx].exitIndex == i) {
+            const Trade& t = trades[tradeIdx];
+            cash = t.shares * t.entryPrice + t.pnl;
+            shares = 0.0;
+            holding = false;
+            tradeIdx++;
+        }
+        
+        equity[i] = holding ? shares * data[i].close : cash;
+        if (position) (*position)[i] = shares;
+    }
+}
+
+double Backtester::finalValue() const {
+    return currentCash + (inPosition ? currentShares * data.back().close : 0.0);
+}
+
+BacktestResult Backtester::getResult(bool includeSeries) const {
+    BacktestResult r;
+    r.config = getConfig();
+    r.finalValue = finalValue();
+    r.metrics = calculateMetrics();
+    r.trades = trades;
+    
+    if (includeSeries) {
+        r.dates.reserve(data.size());
+        for (const auto& bar : data) r.dates.push_back(bar.date);
+        buildEquityCurve(r.equity, &r.position);
+    }
+    return r;
+}
+
+vector<double> Backtester::getBarReturns() const {
+    vector<double> equity;
+    buildEquityCurve(equity);
+    
+    vector<double> returns(equity.size(), 0.0);
+    for (size_t i = 1; i < equity.size(); i++) {
+        returns[i] = equity[i - 1] > 0 ? equity[i] / equity[i - 1] - 1.0 : 0.0;
+    }
+    return returns;
+}
+
+vector<PerformanceMetrics> Backtester::calculateRegimeMetrics(const vector<int>& labels,
+                                                              int numRegimes) const {
+    // Per-regime accumulators, filled in one pass over bars and one over trades
+    struct Accumulator {
+        double growth = 1.0;
+        double peak = 1.0;
+        double maxDD = 0.0;
+        double sumRet = 0.0;
+        double sumRetSq = 0.0;
+        size_t bars = 0;
+        double totalWin = 0.0;
+        double totalLoss = 0.0;
+    };
+    vector<Accumulator> acc(numRegimes);
+    vector<PerformanceMetrics> result(numRegimes, PerformanceMetrics{});
+    
+    vector<double> equity;
+    buildEquityCurve(equity);
+    size_t n = min(equity.size(), labels.size());
+    
+    for (size_t i = 1; i < n; i++) {
+        int r = labels[i];
+        if (r < 0 || r >= numRegimes) continue;
+        
+        double barReturn = equity[i - 1] > 0 ? equity[i] / equity[i - 1] - 1.0 : 0.0;
+        Accumulator& a = acc[r];
+        a.growth *= 1.0 + barReturn;
+        a.sumRet += barReturn;
+        a.sumRetSq += barReturn * barReturn;
+        a.bars++;
+        
+        // Drawdown of the regime-only compounded curve
+        if (a.growth > a.peak) a.peak = a.growth;
+        double dd = ((a.peak - a.growth) / a.peak) * 100.0;
+        if (dd > a.maxDD) a.maxDD = dd;
+    }
+    
+    // Trades are attributed to the regime at their entry signal
+    for (const auto& t : trades) {
+        if (t.entryIndex >= labels.size()) continue;
+        int r = labels[t.entryIndex];
+        if (r < 0 || r >= numRegimes) continue;
+        
+        PerformanceMetrics& m = result[r];
+        m.numTrades++;
+        if (t.pnl > 0) {
+            m.winningTrades++;
+            acc[r].totalWin += t.pnl;
+        } else {
+            acc[r].totalLoss += -t.pnl;
+        }
+    }
+    
+    for (int r = 0; r < numRegimes; r++) {
+        const Accumulator& a = acc[r];
+        PerformanceMetrics& m = result[r];
+        
+        m.totalReturn = (a.growth - 1.0) * 100.0;
+        double years = a.bars / 252.0;
+        m.cagr = years > 0 ? (pow(a.growth, 1.0 / years) - 1.0) * 100.0 : 0.0;
+        m.maxDrawdown = a.maxDD;
+        
+        // Bar-level annualized Sharpe (regimes are not contiguous, so per-trade spacing is meaningless)
+        if (a.bars > 1) {
+            double mean = a.sumRet / a.bars;
+            double variance = a.sumRetSq / a.bars - mean * mean;
+            m.sharpeRatio = variance > 0 ? (mean / sqrt(variance)) * sqrt(252.0) : 0.0;
+        }
+        
+        int losing = m.numTrades - m.winningTrades;
+        m.winRate = m.numTrades > 0 ? (m.winningTrades * 100.0 / m.numTrades) : 0.0;
+        m.avgWin = m.winningTrades > 0 ? a.totalWin / m.winningTrades : 0.0;
+        m.avgLoss = losing > 0 ? a.totalLoss / losing : 0.0;
+        m.profitFactor = a.totalLoss > 0 ? a.totalWin / a.totalLoss : (a.totalWin > 0 ? 999.99 : 0.0);
+    }
+    
+    return result;
+}
+
 double Backtester::calculateYears(const string& start, const string& end) const {
     int startYear = stoi(start.substr(0, 4));
     int endYear = stoi(end.substr(0, 4));
@@ -331,56 +597,22 @@ double Backtester::calculateYears(const string& start, const string& end) const
 }
 
 void Backtester::exportResults(const string& filename) const {
-      // Create results directory if it doesn't exist
-    #ifdef _WIN32
-        _mkdir("results");
-    #else
-        mkdir("results", 0777);
-    #endif
-    ofstream file(filename);
-    
-    file << "BACKTEST SUMMARY\n";
-    file << "================\n\n";
-    
-    auto metrics = calculateMetrics();
-    
-    file << "Initial Capital,$" << fixed << setprecision(2) << initialCapital << "\n";
-    double finalValue = currentCash + (inPosition ? currentShares * data.back().close : 0.0);
-    file << "Final Value,$" << finalValue << "\n";
-    file << "Total Return," << setprecision(2) << metrics.totalReturn << "%\n";
-    file << "CAGR," << metrics.cagr << "%\n";
-    file << "Max Drawdown," << metrics.maxDrawdown << "%\n";
-    file << "Sharpe Ratio," << setprecision(3) << metrics.sharpeRatio << "\n";
-    file << "Number of Trades," << metrics.numTrades << "\n";
-    file << "Winning Trades," << metrics.winningTrades << "\n";
-    file << "Win Rate," << setprecision(2) << metrics.winRate << "%\n";
-    file << "Average Win,$" << metrics.avgWin << "\n";
-    file << "Average Loss,$" << metrics.avgLoss << "\n";
-    file << "Profit Factor," << metrics.profitFactor << "\n\n";
-    
-    file << "TRADE LOG\n";
-    file << "=========\n";
-    file << "Entry Date,Exit Date,Entry Price,Exit Price,Shares,P&L,Return %\n";
-    
-    for (const auto& t : trades) {
-        file << t.entryDate << "," << t.exitDate << ","
-             << fixed << setprecision(2)
-             << t.entryPrice << "," << t.exitPrice << ","
-             << setprecision(4) << t.shares << ","
-             << setprecision(2) << t.pnl << ","
-             << t.returnPct << "%\n";
-    }
-    
-    file.close();
+    ResultExport::writeCSV(filename, initialCapital, finalValue(), calculateMetrics(), trades);
+}
+
+void Backtester::exportBinary(const string& filename) const {
+    ResultExport::writeBinary(filename, getResult(true));
 }
 
 void Backtester::printSummary() const {
-    auto metrics = calculateMetrics();
-    
+    printSummary(initialCapital, finalValue(), calculateMetrics());
+}
+
+void Backtester::printSummary(double initialCapital, double finalValue,
+                              const PerformanceMetrics& metrics) {
     cout << "\n=== BACKTEST RESULTS ===\n";
     cout << fixed << setprecision(2);
     cout << "Initial Capital: $" << initialCapital << "\n";
-    double finalValue = currentCash + (inPosition ? currentShares * data.back().close : 0.0);
     cout << "Final Value: $" << finalValue << "\n";
     cout << "Total Return: " << metrics.totalReturn << "%\n";
     cout << "CAGR: " << metrics.cagr << "%\n";
@@ -0,0 +1,129 @@
+#include "../include/BinaryResultReader.hpp"
+#include "../include/ResultExport.hpp"
+#include <cstring>
+#include <stdexcept>
+using namespace std;
+
+namespace {
+string readDate(const char* p) {
+    return string(p, strnlen(p, BINARY_DATE_CHARS));
+}
+
+// count records of recordSize starting at offset lie inside the file and the
+// section is 8-byte aligned; written so that no product or sum can overflow
+bool sectionFits(uint64_t offset, uint64_t count, uint64_t recordSize, uint64_t size) {
+    return offset % 8 == 0 && offset <= size && count <= (size - offset) / recordSize;
+}
+}
+
+BinaryResultReader::BinaryResultReader(const string& filename)
+    : file(filename), hdr(nullptr) {
+    if (file.size() < sizeof(BinaryResultHeader)) {
+        throw runtime_error("Truncated binary result file: " + filename);
+    }
+    hdr = file.at<BinaryResultHeader>(0);
+    
+    if (memcmp(hdr->magic, BINARY_RESULT_MAGIC, sizeof(hdr->magic)) != 0) {
+        throw runtime_error("Not a binary result file: " + filename);
+    }
+    if (hdr->major != BINARY_RESULT_MAJOR) {
+        throw runtime_error("Unsupported binary result version in " + filename);
+    }
+    if (hdr->metricsSize < sizeof(BinaryMetrics) || hdr->tradeRecordSize < sizeof(BinaryTrade)) {
+        throw runtime_error("Binary result records too small in " + filename);
+    }
+    // Offsets and counts come from the file: a corrupt header must be rejected
+    // here, before any accessor dereferences them
+    uint64_t size = file.size();
+    if (hdr->fileSize > size ||
+        !sectionFits(hdr->metricsOffset, 1, hdr->metricsSize, size) ||
+        !sectionFits(hdr->tradesOffset, hdr->numTrades, hdr->tradeRecordSize, size) ||
+        !sectionFits(hdr->datesOffset, hdr->numBars, BINARY_DATE_CHARS, size) ||
+        !sectionFits(hdr->equityOffset, hdr->numBars, sizeof(double), size) ||
+        !sectionFits(hdr->positionOffset, hdr->numBars, sizeof(double), size)) {
+        throw runtime_error("Truncated or corrupt binary result file: " + filename);
+    }
+}
+
+const BinaryMetrics& BinaryResultReader::metrics() const {
+    return *file.at<BinaryMetrics>(hdr->metricsOffset);
+}
+
+const BinaryTrade& BinaryResultReader::trade(size_t i) const {
+    return *file.at<BinaryTrade>(hdr->tradesOffset + i * hdr->tradeRecordSize);
+}
+
+const double* BinaryResultReader::equity() const {
+    return file.at<double>(hdr->equityOffset);
+}
+
+const double* BinaryResultReader::position() const {
+    return file.at<double>(hdr->positionOffset);
+}
+
+string BinaryResultReader::barDate(size_t i) const {
+    return readDate(file.at<char>(hdr->datesOffset + i * BINARY_DATE_CHARS));
+}
+
+BacktestResult BinaryResultReader::toResult(bool includeSeries) const {
+    const BinaryMetrics& bm = metrics();
+    BacktestResult r;
+    
+    r.config.shortMA = bm.shortMA;
+    r.config.longMA = bm.longMA;
+    r.config.initialCapital = bm.initialCapital;
+    r.config.useRSI = (bm.flags & 1u) != 0;
+    r.config.useEMA = (bm.flags & 2u) != 0;
+    r.config.useMACD = (bm.flags & 4u) != 0;
+    r.config.useBollinger = (bm.flags & 8u) != 0;
+    r.config.useKelly = (bm.flags & 16u) != 0;
+    r.config.stopLoss = bm.stopLoss;
+    r.config.takeProfit = bm.takeProfit;
+    r.config.commission = bm.commission;
+    r.config.slippage = bm.slippage;
+    
+    r.finalValue = bm.finalValue;
+    r.metrics.totalReturn = bm.totalReturn;
+    r.metrics.cagr = bm.cagr;
+    r.metrics.maxDrawdown = bm.maxDrawdown;
+    r.metrics.sharpeRatio = bm.sharpeRatio;
+    r.metrics.numTrades = static_cast<int>(bm.numTrades);
+    r.metrics.winningTrades = static_cast<int>(bm.winningTrades);
+    r.metrics.winRate = bm.winRate;
+    r.metrics.avgWin = bm.avgWin;
+    r.metrics.avgLoss = bm.avgLoss;
+    r.metrics.profitFactor = bm.profitFactor;
+    
+    r.trades.resize(numTrades());
+    for (size_t i = 0; i < numTrades(); i++) {
+        const BinaryTrade& bt = trade(i);
+        Trade& t = r.trades[i];
+        t.entryDate = readDate(bt.entryDate);
+        t.exitDate = readDate(bt.exitDate);
+        t.entryPrice = bt.entryPrice;
+        t.exitPrice = bt.exitPrice;
+        t.shares = bt.shares;
+        t.pnl = bt.pnl;
+        t.returnPct = bt.returnPct;
+        t.entryIndex = static_cast<size_t>(bt.entryIndex);
+        t.exitIndex = static_cast<size_t>(bt.exitIndex);
+        if (bt.exitReason > EXIT_END_OF_DATA) {
+            throw runtime_error("Corrupt exit reason in binary result trade " + to_string(i));
+        }
+        t.exitReason = static_cast<ExitReason>(bt.exitReason);
+    }
+    
+    if (!includeSeries) return r;
+    
+    size_t bars = numBars();
+    r.dates.resize(bars);
+    for (size_t i = 0; i < bars; i++) r.dates[i] = barDate(i);
+    r.equity.assign(equity(), equity() + bars);
+    r.position.assign(position(), position() + bars);
+    return r;
+}
+
+bool BinaryResultReader::toCSV(const string& filename) const {
+    BacktestResult r = toResult(false);
+    return ResultExport::writeCSV(filename, r);
+}
@@ -1,10 +1,12 @@
 #include "../include/CSVParser.hpp"
+#include "../include/Profiler.hpp"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <stdexcept>
 using namespace std;
 vector<OHLCV> CSVParser::parse(const string& filename) {
+    PROFILE_TIMER(timer, STAGE_PARSE, 0);
     vector<OHLCV> data;
     ifstream file(filename);
     
@@ -22,6 +24,7 @@ vector<OHLCV> CSVParser::parse(const string& filename) {
         data.push_back(row);
     }
     
+    PROFILE_ITEMS(timer, data.size());
     return data;
 }
 
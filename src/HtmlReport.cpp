@@ -0,0 +1,251 @@
+#include "../include/HtmlReport.hpp"
+#include "../include/ReportWriter.hpp"
+#include "../include/JsonWriter.hpp"
+#include "../include/ResultExport.hpp"
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+namespace {
+const double WIDTH = 960.0;
+const double EQUITY_HEIGHT = 320.0;
+const double DRAWDOWN_HEIGHT = 140.0;
+const double PAD = 8.0;
+
+// Bar index / value -> SVG coordinates for one chart
+struct Scale {
+    double xScale;
+    double yMin;
+    double yScale;
+    double height;
+    
+    Scale(size_t bars, double lo, double hi, double h) : height(h) {
+        xScale = (WIDTH - 2 * PAD) / max<double>(1.0, static_cast<double>(bars) - 1.0);
+        if (hi <= lo) hi = lo + 1.0;
+        yMin = lo;
+        yScale = (h - 2 * PAD) / (hi - lo);
+    }
+    double x(size_t i) const { return PAD + i * xScale; }
+    double y(double v) const { return height - PAD - (v - yMin) * yScale; }
+};
+
+// Line through the kept points; with a baseline, a filled area down to it
+void polyline(ReportWriter& out, const vector<size_t>& idx, const vector<double>& values,
+              const Scale& s, const char* cssClass, const double* baseline = nullptr) {
+    out.text(baseline ? "<polygon" : "<polyline").text(" class=\"").text(cssClass).text("\" points=\"");
+    if (baseline) {
+        out.fixed(s.x(idx.front()), 1).put(',').fixed(s.y(*baseline), 1).put(' ');
+    }
+    for (size_t k = 0; k < idx.size(); k++) {
+        if (k > 0) out.put(' ');
+        out.fixed(s.x(idx[k]), 1).put(',').fixed(s.y(values[idx[k]]), 1);
+    }
+    if (baseline) {
+        out.put(' ').fixed(s.x(idx.back()), 1).put(',').fixed(s.y(*baseline), 1);
+    }
+    out.text("\"/>\n");
+}
+
+// Text node content: markup characters from the data must not become tags
+void escaped(ReportWriter& out, const string& s) {
+    size_t start = 0;
+    for (size_t i = 0; i < s.size(); i++) {
+        const char* entity = nullptr;
+        switch (s[i]) {
+            case '&': entity = "&amp;"; break;
+            case '<': entity = "&lt;"; break;
+            case '>': entity = "&gt;"; break;
+            case '"': entity = "&quot;"; break;
+            case '\'': entity = "&#39;"; break;
+            default: continue;
+        }
+        out.text(s.data() + start, i - start).text(entity);
+        start = i + 1;
+    }
+    out.text(s.data() + start, s.size() - start);
+}
+
+void metricRow(ReportWriter& out, const char* name, double value, int precision, const char* suffix) {
+    out.text("<tr><td>").text(name).text("</td><td>")
+        .fixed(value, precision).text(suffix).text("</td></tr>\n");
+}
+
+// Sampled points for the hover readout: [x, date, equity, drawdown %]
+void pointData(ReportWriter& out, const vector<size_t>& idx, const BacktestResult& r,
+               const vector<double>& drawdown, const Scale& s) {
+    JsonWriter json(out, true);
+    json.beginArray();
+    for (size_t i : idx) {
+        json.beginArray()
+            .value(round(s.x(i) * 10.0) / 10.0)
+            .value(i < r.dates.size() ? r.dates[i] : string())
+            .value(round(r.equity[i] * 100.0) / 100.0)
+            .value(round(-drawdown[i] * 100.0) / 100.0)
+            .endArray();
+    }
+    json.endArray();
+}
+
+const char* STYLE =
+    "body{font-family:system-ui,sans-serif;margin:24px;color:#222}"
+    "table{border-collapse:collapse;margin-bottom:16px}"
+    "td{padding:2px 14px 2px 0}td:last-child{text-align:right;font-variant-numeric:tabular-nums}"
+    "svg{display:block;background:#fafafa;border:1px solid #ddd;margin-bottom:8px}"
+    ".eq{fill:none;stroke:#1f5fbf;stroke-width:1.2}"
+    ".dd{fill:#d64541;fill-opacity:.25;stroke:#d64541;stroke-width:1}"
+    ".in{fill:#2a9d4b}.out{fill:#d64541}"
+    "#tip{position:fixed;pointer-events:none;background:#fff;border:1px solid #aaa;"
+    "padding:2px 6px;font-size:12px;display:none}"
+    "#cur{stroke:#888;stroke-dasharray:3}";
+
+// Nearest sampled point under the cursor (binary search on x)
+const char* SCRIPT =
+    "const svg=document.getElementById('equity'),tip=document.getElementById('tip'),"
+    "cur=document.getElementById('cur');"
+    "svg.addEventListener('mousemove',e=>{const r=svg.getBoundingClientRect(),"
+    "x=(e.clientX-r.left)*svg.viewBox.baseVal.width/r.width;let lo=0,hi=P.length-1;"
+    "while(lo<hi){const m=(lo+hi)>>1;if(P[m][0]<x)lo=m+1;else hi=m;}"
+    "if(lo>0&&x-P[lo-1][0]<P[lo][0]-x)lo--;const p=P[lo];"
+    "cur.setAttribute('x1',p[0]);cur.setAttribute('x2',p[0]);"
+    "tip.textContent=p[1]+'  equity '+p[2].toLocaleString()+'  dd '+p[3]+'%';"
+    "tip.style.display='block';tip.style.left=(e.clientX+12)+'px';tip.style.top=(e.clientY+12)+'px';});"
+    "svg.addEventListener('mouseleave',()=>{tip.style.display='none';});";
+}
+
+vector<size_t> HtmlReport::lttb(const vector<double>& y, size_t threshold) {
+    size_t n = y.size();
+    vector<size_t> kept;
+    if (threshold >= n || threshold < 3) {
+        kept.resize(n);
+        for (size_t i = 0; i < n; i++) kept[i] = i;
+        return kept;
+    }
+    
+    kept.reserve(threshold);
+    kept.push_back(0);
+    double every = static_cast<double>(n - 2) / (threshold - 2);
+    size_t a = 0;
+    
+    for (size_t b = 0; b < threshold - 2; b++) {
+        // Average of the next bucket is the third triangle vertex; x is the
+        // index, so its mean is the bucket midpoint
+        size_t nextStart = static_cast<size_t>((b + 1) * every) + 1;
+        size_t nextEnd = min(static_cast<size_t>((b + 2) * every) + 1, n);
+        double sum[4] = {0.0, 0.0, 0.0, 0.0};
+        size_t j = nextStart;
+        for (; j + 4 <= nextEnd; j += 4) {
+            for (int k = 0; k < 4; k++) sum[k] += y[j + k];
+        }
+        for (; j < nextEnd; j++) sum[0] += y[j];
+        double avgX = 0.5 * (nextStart + nextEnd - 1);
+        double avgY = (sum[0] + sum[1] + sum[2] + sum[3]) / (nextEnd - nextStart);
+        
+        // Twice the triangle area is linear in (i, y[i]): |dx*y[i] + dy*i - c|
+        double ax = static_cast<double>(a), ay = y[a];
+        double dx = ax - avgX, dy = avgY - ay;
+        double c = dx * ay + dy * ax;
+        
+        size_t start = static_cast<size_t>(b * every) + 1;
+        size_t end = static_cast<size_t>((b + 1) * every) + 1;
+        double bestArea = -1.0;
+        size_t best = start;
+        for (size_t i = start; i < end; i++) {
+            double area = fabs(dx * y[i] + dy * static_cast<double>(i) - c);
+            best = area > bestArea ? i : best;
+            bestArea = max(area, bestArea);
+        }
+        kept.push_back(best);
+        a = best;
+    }
+    
+    kept.push_back(n - 1);
+    return kept;
+}
+
+bool HtmlReport::write(const string& filename, const BacktestResult& r, size_t maxPoints) {
+    ResultExport::ensureParentDirectory(filename);
+    ReportWriter out(filename);
+    if (!out.isOpen()) return false;
+    
+    const auto& m = r.metrics;
+    const auto& c = r.config;
+    size_t bars = r.equity.size();
+    
+    // One pass for the drawdown (stored <= 0, as plotted) and both chart ranges
+    vector<double> drawdown(bars);
+    double peak = bars > 0 ? r.equity[0] : 0.0;
+    double lo = peak, hi = peak, deepest = 0.0;
+    for (size_t i = 0; i < bars; i++) {
+        double e = r.equity[i];
+        peak = max(peak, e);
+        lo = min(lo, e);
+        hi = max(hi, e);
+        drawdown[i] = peak > 0 ? (e - peak) / peak * 100.0 : 0.0;
+        deepest = min(deepest, drawdown[i]);
+    }
+    
+    out.text("<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\">\n<title>Backtest ")
+        .integer(c.shortMA).put('/').integer(c.longMA).text("</title>\n<style>")
+        .text(STYLE).text("</style></head><body>\n");
+    
+    out.text("<h2>").text(c.useEMA ? "EMA" : "SMA").text(" Crossover (")
+        .integer(c.shortMA).put('/').integer(c.longMA).text(")");
+    if (!r.dates.empty()) {
+        out.text(" &middot; ");
+        escaped(out, r.dates.front());
+        out.text(" to ");
+        escaped(out, r.dates.back());
+    }
+    out.text("</h2>\n<table>\n");
+    metricRow(out, "Initial Capital", c.initialCapital, 2, "");
+    metricRow(out, "Final Value", r.finalValue, 2, "");
+    metricRow(out, "Total Return", m.totalReturn, 2, "%");
+    metricRow(out, "CAGR", m.cagr, 2, "%");
+    metricRow(out, "Max Drawdown", m.maxDrawdown, 2, "%");
+    metricRow(out, "Sharpe Ratio", m.sharpeRatio, 3, "");
+    metricRow(out, "Trades", m.numTrades, 0, "");
+    metricRow(out, "Win Rate", m.winRate, 2, "%");
+    metricRow(out, "Profit Factor", m.profitFactor, 2, "");
+    metricRow(out, "Commission", c.commission * 100.0, 3, "%");
+    metricRow(out, "Slippage", c.slippage * 100.0, 3, "%");
+    out.text("</table>\n");
+    
+    if (bars > 0) {
+        vector<size_t> eqIdx = lttb(r.equity, maxPoints);
+        
+        Scale eq(bars, lo, hi, EQUITY_HEIGHT);
+        Scale dd(bars, deepest, 0.0, DRAWDOWN_HEIGHT);
+        
+        out.text("<h3>Equity</h3>\n<svg id=\"equity\" viewBox=\"0 0 ").fixed(WIDTH, 0).put(' ')
+            .fixed(EQUITY_HEIGHT, 0).text("\">\n");
+        polyline(out, eqIdx, r.equity, eq, "eq");
+        for (const auto& t : r.trades) {
+            if (t.entryIndex < bars) {
+                out.text("<circle class=\"in\" r=\"3\" cx=\"").fixed(eq.x(t.entryIndex), 1)
+                    .text("\" cy=\"").fixed(eq.y(r.equity[t.entryIndex]), 1).text("\"/>");
+            }
+            if (t.exitIndex < bars) {
+                out.text("<circle class=\"out\" r=\"3\" cx=\"").fixed(eq.x(t.exitIndex), 1)
+                    .text("\" cy=\"").fixed(eq.y(r.equity[t.exitIndex]), 1).text("\"/>\n");
+            }
+        }
+        out.text("<line id=\"cur\" y1=\"0\" y2=\"").fixed(EQUITY_HEIGHT, 0).text("\"/>\n</svg>\n");
+        
+        // Drawdown plotted downward from the top edge as a filled area
+        vector<size_t> ddIdx = lttb(drawdown, maxPoints);
+        out.text("<h3>Drawdown</h3>\n<svg viewBox=\"0 0 ").fixed(WIDTH, 0).put(' ')
+            .fixed(DRAWDOWN_HEIGHT, 0).text("\">\n");
+        double zero = 0.0;
+        polyline(out, ddIdx, drawdown, dd, "dd", &zero);
+        out.text("</svg>\n");
+        
+        out.text("<p>").integer(bars).text(" bars, ").integer(eqIdx.size())
+            .text(" plotted points, green/red = entries/exits</p>\n<div id=\"tip\"></div>\n");
+        out.text("<script>const P=");
+        pointData(out, eqIdx, r, drawdown, eq);
+        out.text(";\n").text(SCRIPT).text("</script>\n");
+    }
+    
+    out.text("</body></html>\n");
+    return out.close();
+}
@@ -0,0 +1,122 @@
+#include "../include/JsonWriter.hpp"
+#include <cmath>
+#include <cstring>
+using namespace std;
+
+void JsonWriter::separator() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (!hasElements.empty()) {
+        if (hasElements.back()) out.put(',');
+        hasElements.back() = true;
+    }
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separator();
+    out.put('{');
+    hasElements.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    hasElements.pop_back();
+    out.put('}');
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separator();
+    out.put('[');
+    hasElements.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    hasElements.pop_back();
+    out.put(']');
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const char* name) {
+    separator();
+    string(name, strlen(name));
+    out.put(':');
+    afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double v) {
+    separator();
+    if (std::isfinite(v)) {
+        out.shortest(v);
+    } else {
+        out.text("null", 4);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(long long v) {
+    separator();
+    out.integer(v);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool v) {
+    separator();
+    if (v) out.text("true", 4); else out.text("false", 5);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* s) {
+    separator();
+    string(s, strlen(s));
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const std::string& s) {
+    separator();
+    string(s.data(), s.size());
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separator();
+    out.text("null", 4);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endRecord() {
+    out.put('\n');
+    return *this;
+}
+
+void JsonWriter::string(const char* s, size_t n) {
+    static const char HEX[] = "0123456789abcdef";
+    out.put('"');
+    
+    // Copy runs of safe characters in one go
+    size_t start = 0;
+    for (size_t i = 0; i < n; i++) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\' && !(c == '<' && scriptSafe)) continue;
+        
+        out.text(s + start, i - start);
+        switch (c) {
+            case '"': out.text("\\\"", 2); break;
+            case '\\': out.text("\\\\", 2); break;
+            case '\n': out.text("\\n", 2); break;
+            case '\r': out.text("\\r", 2); break;
+            case '\t': out.text("\\t", 2); break;
+            default: {
+                char esc[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF]};
+                out.text(esc, 6);
+            }
+        }
+        start = i + 1;
+    }
+    out.text(s + start, n - start);
+    out.put('"');
+}
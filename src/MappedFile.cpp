@@ -0,0 +1,123 @@
+#include "../include/MappedFile.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+MappedFile::MappedFile(const string& filename) : base(nullptr), length(0) {
+#ifdef _WIN32
+    ifstream file(filename, ios::binary | ios::ate);
+    if (!file.is_open()) {
+        throw runtime_error("Cannot open file: " + filename);
+    }
+    length = static_cast<size_t>(file.tellg());
+    fallback.resize(length);
+    file.seekg(0);
+    file.read(fallback.data(), length);
+    base = fallback.data();
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("Cannot open file: " + filename);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw runtime_error("Cannot stat file: " + filename);
+    }
+    length = static_cast<size_t>(st.st_size);
+    if (length > 0) {
+        void* p = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            throw runtime_error("Cannot map file: " + filename);
+        }
+        base = static_cast<const char*>(p);
+    }
+    close(fd);
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (base && length > 0) {
+        munmap(const_cast<char*>(base), length);
+    }
+#endif
+}
+
+MappedOutputFile::MappedOutputFile(const string& filename, size_t size)
+    : path(filename), base(nullptr), length(size) {
+#ifdef _WIN32
+    fallback.resize(length);
+    base = fallback.data();
+#else
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw runtime_error("Cannot create file: " + filename);
+    }
+    // Reserve the blocks up front: a store into a sparse hole on a full disk
+    // would raise SIGBUS mid-run instead of failing here
+    if (length > 0) {
+        int err = posix_fallocate(fd, 0, static_cast<off_t>(length));
+        if (err != 0) {
+            close(fd);
+            unlink(filename.c_str());
+            throw runtime_error("Cannot reserve " + to_string(length) + " bytes for " + filename + ": " +
+                                strerror(err));
+        }
+    }
+    if (length > 0) {
+        void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            throw runtime_error("Cannot map file: " + filename);
+        }
+        base = static_cast<char*>(p);
+    }
+    close(fd);
+#endif
+}
+
+MappedOutputFile::~MappedOutputFile() {
+#ifdef _WIN32
+    ofstream file(path, ios::binary);
+    file.write(fallback.data(), fallback.size());
+#else
+    if (base && length > 0) {
+        munmap(base, length);
+    }
+#endif
+}
+
+void MappedOutputFile::release(size_t offset, size_t n) {
+#ifndef _WIN32
+    static const size_t PAGE = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    // Only whole pages inside the range; partial pages may still be written
+    size_t begin = (offset + PAGE - 1) / PAGE * PAGE;
+    size_t end = min(offset + n, length) / PAGE * PAGE;
+    if (!base || begin >= end) return;
+    msync(base + begin, end - begin, MS_ASYNC);
+    madvise(base + begin, end - begin, MADV_DONTNEED);
+#else
+    (void)offset;
+    (void)n;
+#endif
+}
+
+void MappedOutputFile::sync() {
+#ifndef _WIN32
+    if (base && length > 0) {
+        msync(base, length, MS_SYNC);
+    }
+#endif
+}
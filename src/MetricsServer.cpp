@@ -0,0 +1,140 @@
+#include "../include/MetricsServer.hpp"
+#include "../include/RuntimeMetrics.hpp"
+#include "../include/Tracer.hpp"
+#include <string>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+namespace {
+const int POLL_MS = 200;               // How quickly stop() is noticed
+const size_t MAX_REQUEST = 8192;
+
+#ifndef _WIN32
+void sendAll(int fd, const string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        sent += static_cast<size_t>(n);
+    }
+}
+
+string response(const char* status, const char* contentType, const string& body) {
+    return string("HTTP/1.0 ") + status + "\r\n" +
+        "Content-Type: " + contentType + "\r\n" +
+        "Content-Length: " + to_string(body.size()) + "\r\n" +
+        "Connection: close\r\n\r\n" + body;
+}
+#endif
+}
+
+MetricsServer::MetricsServer(int port) : listenFd(-1), boundPort(0), stopping(false) {
+#ifndef _WIN32
+    if (port < 0 || port > 65535) throw runtime_error("Invalid metrics port " + to_string(port));
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) throw runtime_error(string("Cannot create metrics socket: ") + strerror(errno));
+    int reuse = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    
+    // Loopback only: the endpoint has no authentication
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listenFd, 16) != 0) {
+        string error = strerror(errno);
+        close(listenFd);
+        throw runtime_error("Cannot listen on 127.0.0.1:" + to_string(port) + ": " + error);
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &len);
+    boundPort = ntohs(addr.sin_port);
+    
+    worker = thread(&MetricsServer::serve, this);
+#else
+    (void)port;
+    throw runtime_error("The metrics endpoint needs POSIX sockets");
+#endif
+}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+void MetricsServer::stop() {
+    stopping = true;
+    if (worker.joinable()) worker.join();
+#ifndef _WIN32
+    if (listenFd >= 0) {
+        close(listenFd);
+        listenFd = -1;
+    }
+#endif
+}
+
+void MetricsServer::serve() {
+#ifndef _WIN32
+    Tracer::setThreadName("metrics server");
+    while (!stopping) {
+        pollfd p = {listenFd, POLLIN, 0};
+        if (poll(&p, 1, POLL_MS) <= 0) continue;
+        int client = accept(listenFd, nullptr, nullptr);
+        if (client < 0) continue;
+        answer(client);
+        close(client);
+    }
+#endif
+}
+
+void MetricsServer::answer(int client) {
+#ifndef _WIN32
+    // A stalled client must not hold the endpoint for long
+    timeval timeout = {1, 0};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    
+    string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == string::npos && request.size() < MAX_REQUEST) {
+        ssize_t n = recv(client, buf, sizeof(buf), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        request.append(buf, static_cast<size_t>(n));
+    }
+    
+    // Request line: METHOD SP PATH SP VERSION
+    size_t methodEnd = request.find(' ');
+    size_t pathEnd = methodEnd == string::npos ? string::npos : request.find(' ', methodEnd + 1);
+    if (pathEnd == string::npos) {
+        sendAll(client, response("400 Bad Request", "text/plain", "Bad request\n"));
+        return;
+    }
+    string method = request.substr(0, methodEnd);
+    string path = request.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+    path = path.substr(0, path.find('?'));
+    
+    if (method != "GET" && method != "HEAD") {
+        sendAll(client, response("405 Method Not Allowed", "text/plain", "Only GET is supported\n"));
+    } else if (path == "/metrics" || path == "/") {
+        string body = RuntimeMetrics::exposition();
+        string reply = response("200 OK", "text/plain; version=0.0.4; charset=utf-8", body);
+        if (method == "HEAD") reply.resize(reply.size() - body.size());
+        sendAll(client, reply);
+    } else {
+        sendAll(client, response("404 Not Found", "text/plain", "Metrics are served at /metrics\n"));
+    }
+#else
+    (void)client;
+#endif
+}
@@ -0,0 +1,184 @@
+#include "../include/PerfCounters.hpp"
+#include <cmath>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <atomic>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+PerfCounts PerfCounts::operator-(const PerfCounts& start) const {
+    PerfCounts d;
+    d.validMask = validMask & start.validMask;
+    for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+        // Scaled totals can step back slightly when multiplexing estimates change
+        d.value[e] = value[e] > start.value[e] ? value[e] - start.value[e] : 0;
+    }
+    return d;
+}
+
+PerfCounts& PerfCounts::operator+=(const PerfCounts& other) {
+    validMask |= other.validMask;
+    for (int e = 0; e < NUM_PERF_EVENTS; e++) value[e] += other.value[e];
+    return *this;
+}
+
+namespace {
+double ratio(const PerfCounts& c, PerfEvent num, PerfEvent den) {
+    if (!c.has(num) || !c.has(den) || c.value[den] == 0) return NAN;
+    return static_cast<double>(c.value[num]) / c.value[den];
+}
+
+#ifdef __linux__
+struct EventConfig {
+    uint32_t type;
+    uint64_t config;
+};
+
+uint64_t cacheEvent(uint64_t cache, uint64_t result) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+}
+
+const EventConfig EVENT_CONFIGS[NUM_PERF_EVENTS] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_ACCESS)},
+    {PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_RESULT_ACCESS)},
+    {PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+};
+
+// errno of the first failed counter that available() needs (cycles or
+// instructions); 0 while both opened
+atomic<int> openErrno{0};
+
+// One set of counters per thread, closed when the thread exits
+struct ThreadCounters {
+    int fd[NUM_PERF_EVENTS];
+    
+    ThreadCounters() {
+        for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = EVENT_CONFIGS[e].type;
+            attr.config = EVENT_CONFIGS[e].config;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fd[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fd[e] < 0 && (e == PERF_CYCLES || e == PERF_INSTRUCTIONS)) {
+                int expected = 0;
+                openErrno.compare_exchange_strong(expected, errno);
+            }
+        }
+    }
+    
+    ~ThreadCounters() {
+        for (int f : fd) {
+            if (f >= 0) close(f);
+        }
+    }
+    
+    ThreadCounters(const ThreadCounters&) = delete;
+    ThreadCounters& operator=(const ThreadCounters&) = delete;
+};
+
+ThreadCounters& threadCounters() {
+    thread_local ThreadCounters counters;
+    return counters;
+}
+
+int paranoidLevel() {
+    ifstream in("/proc/sys/kernel/perf_event_paranoid");
+    int level = -99;
+    in >> level;
+    return level;
+}
+#endif
+}
+
+double PerfCounts::ipc() const {
+    return ratio(*this, PERF_INSTRUCTIONS, PERF_CYCLES);
+}
+
+double PerfCounts::l1MissRate() const {
+    return ratio(*this, PERF_L1D_LOAD_MISSES, PERF_L1D_LOADS);
+}
+
+double PerfCounts::llcMissRate() const {
+    return ratio(*this, PERF_LLC_LOAD_MISSES, PERF_LLC_LOADS);
+}
+
+double PerfCounts::branchMissRate() const {
+    return ratio(*this, PERF_BRANCH_MISSES, PERF_BRANCHES);
+}
+
+bool PerfCounters::available() {
+#ifdef __linux__
+    const ThreadCounters& c = threadCounters();
+    return c.fd[PERF_CYCLES] >= 0 && c.fd[PERF_INSTRUCTIONS] >= 0;
+#else
+    return false;
+#endif
+}
+
+string PerfCounters::unavailableReason() {
+#ifdef __linux__
+    if (available()) return "";
+    int err = openErrno.load();
+    switch (err) {
+        case ENOENT:
+        case EOPNOTSUPP:
+            return "no hardware PMU exposed (container or VM)";
+        case EACCES:
+        case EPERM:
+            return "not permitted (kernel.perf_event_paranoid = " + to_string(paranoidLevel()) + ")";
+        case ENOSYS:
+            return "perf_event_open not supported by this kernel";
+        default:
+            return string("perf_event_open failed: ") + strerror(err);
+    }
+#else
+    return "hardware counters need Linux perf_event_open";
+#endif
+}
+
+PerfCounts PerfCounters::read() {
+    PerfCounts c;
+#ifdef __linux__
+    const ThreadCounters& t = threadCounters();
+    for (int e = 0; e < NUM_PERF_EVENTS; e++) {
+        if (t.fd[e] < 0) continue;
+        // value, time enabled, time running
+        uint64_t buf[3];
+        if (::read(t.fd[e], buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf)) || buf[2] == 0) {
+            continue;
+        }
+        double scale = buf[2] < buf[1] ? static_cast<double>(buf[1]) / buf[2] : 1.0;
+        c.value[e] = static_cast<uint64_t>(buf[0] * scale);
+        c.validMask |= 1u << e;
+    }
+#endif
+    return c;
+}
+
+const char* PerfCounters::eventName(PerfEvent e) {
+    switch (e) {
+        case PERF_CYCLES: return "cycles";
+        case PERF_INSTRUCTIONS: return "instructions";
+        case PERF_BRANCHES: return "branches";
+        case PERF_BRANCH_MISSES: return "branch_misses";
+        case PERF_L1D_LOADS: return "l1d_loads";
+        case PERF_L1D_LOAD_MISSES: return "l1d_load_misses";
+        case PERF_LLC_LOADS: return "llc_loads";
+        case PERF_LLC_LOAD_MISSES: return "llc_load_misses";
+        default: return "unknown";
+    }
+}
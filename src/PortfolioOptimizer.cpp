@@ -0,0 +1,303 @@
+#include "../include/PortfolioOptimizer.hpp"
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+// Tile sizes: a BLOCK_I x BLOCK_J covariance tile (128 KB) stays in L2 while
+// BLOCK_T bars of the return matrix stream through it
+const size_t BLOCK_I = 64;
+const size_t BLOCK_J = 256;
+const size_t BLOCK_T = 128;
+
+const double TRADING_DAYS = 252.0;
+
+double dot(const std::vector<double>& a, const std::vector<double>& b) {
+    double s = 0.0;
+    for (size_t i = 0; i < a.size(); i++) s += a[i] * b[i];
+    return s;
+}
+}
+
+PortfolioOptimizer::PortfolioOptimizer(const std::vector<std::vector<double>>& returnStreams)
+    : n(returnStreams.size()), bars(0) {
+    if (returnStreams.empty()) {
+        throw std::invalid_argument("PortfolioOptimizer: no return streams");
+    }
+    bars = returnStreams[0].size();
+    for (const auto& s : returnStreams) {
+        if (s.size() != bars) {
+            throw std::invalid_argument("PortfolioOptimizer: return streams differ in length");
+        }
+    }
+    if (bars < 2) {
+        throw std::invalid_argument("PortfolioOptimizer: need at least two bars");
+    }
+    buildCovariance(returnStreams);
+}
+
+void PortfolioOptimizer::buildCovariance(const std::vector<std::vector<double>>& returnStreams) {
+    mean.assign(n, 0.0);
+    for (size_t i = 0; i < n; i++) {
+        mean[i] = std::accumulate(returnStreams[i].begin(), returnStreams[i].end(), 0.0) / bars;
+    }
+    
+    // Demeaned returns, bar-major so the innermost loop is a contiguous axpy
+    std::vector<double> x(bars * n);
+    for (size_t i = 0; i < n; i++) {
+        const double* src = returnStreams[i].data();
+        for (size_t t = 0; t < bars; t++) {
+            x[t * n + i] = src[t] - mean[i];
+        }
+    }
+    
+    // Upper-triangular tiles of X'X; the compiler vectorizes the j loop
+    cov.assign(n * n, 0.0);
+    for (size_t ib = 0; ib < n; ib += BLOCK_I) {
+        size_t iEnd = std::min(ib + BLOCK_I, n);
+        for (size_t jb = (ib / BLOCK_J) * BLOCK_J; jb < n; jb += BLOCK_J) {
+            size_t jEnd = std::min(jb + BLOCK_J, n);
+            for (size_t tb = 0; tb < bars; tb += BLOCK_T) {
+                size_t tEnd = std::min(tb + BLOCK_T, bars);
+                for (size_t t = tb; t < tEnd; t++) {
+                    const double* __restrict__ row = &x[t * n];
+                    for (size_t i = ib; i < iEnd; i++) {
+                        double a = row[i];
+                        double* __restrict__ c = &cov[i * n];
+                        for (size_t j = jb; j < jEnd; j++) {
+                            c[j] += a * row[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+    
+    // Mirror into the lower triangle and normalize
+    double scale = 1.0 / (bars - 1);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i; j < n; j++) {
+            double v = cov[i * n + j] * scale;
+            cov[i * n + j] = v;
+            cov[j * n + i] = v;
+        }
+    }
+    
+    // Small ridge keeps flat (never-invested) sleeves from making the matrix singular
+    double trace = 0.0;
+    for (size_t i = 0; i < n; i++) trace += cov[i * n + i];
+    double ridge = trace > 0 ? 1e-10 * trace / n : 1e-16;
+    for (size_t i = 0; i < n; i++) cov[i * n + i] += ridge;
+}
+
+void PortfolioOptimizer::multiply(const std::vector<double>& w, std::vector<double>& y) const {
+    y.assign(n, 0.0);
+    // Symmetric matrix: accumulate rows scaled by w[j] to keep the inner loop contiguous
+    for (size_t j = 0; j < n; j++) {
+        double wj = w[j];
+        if (wj == 0.0) continue;
+        const double* __restrict__ row = &cov[j * n];
+        double* __restrict__ out = y.data();
+        for (size_t i = 0; i < n; i++) {
+            out[i] += wj * row[i];
+        }
+    }
+}
+
+double PortfolioOptimizer::largestEigenvalue() const {
+    std::vector<double> v(n, 1.0 / std::sqrt(static_cast<double>(n)));
+    std::vector<double> y;
+    double lambda = 0.0;
+    
+    for (int it = 0; it < 100; it++) {
+        multiply(v, y);
+        double norm = std::sqrt(dot(y, y));
+        if (norm == 0.0) return 0.0;
+        for (size_t i = 0; i < n; i++) v[i] = y[i] / norm;
+        if (std::fabs(norm - lambda) <= 1e-9 * norm) return norm;
+        lambda = norm;
+    }
+    return lambda;
+}
+
+void PortfolioOptimizer::project(std::vector<double>& w, const PortfolioConstraints& c) {
+    size_t count = w.size();
+    if (c.minWeight * count > 1.0 + 1e-12 || c.maxWeight * count < 1.0 - 1e-12 ||
+        c.minWeight > c.maxWeight) {
+        throw std::invalid_argument("PortfolioOptimizer: weight bounds are infeasible");
+    }
+    
+    // Find tau with sum(clamp(w - tau, lo, hi)) == 1 by bisection
+    double lo = *std::min_element(w.begin(), w.end()) - c.maxWeight;
+    double hi = *std::max_element(w.begin(), w.end()) - c.minWeight;
+    for (int it = 0; it < 100; it++) {
+        double tau = 0.5 * (lo + hi);
+        double sum = 0.0;
+        for (double v : w) sum += std::min(std::max(v - tau, c.minWeight), c.maxWeight);
+        if (sum > 1.0) lo = tau; else hi = tau;
+    }
+    double tau = 0.5 * (lo + hi);
+    for (double& v : w) v = std::min(std::max(v - tau, c.minWeight), c.maxWeight);
+}
+
+PortfolioWeights PortfolioOptimizer::summarize(const std::vector<double>& w, int iterations) const {
+    std::vector<double> sw;
+    multiply(w, sw);
+    
+    PortfolioWeights result;
+    result.weights = w;
+    result.expectedReturn = dot(w, mean) * TRADING_DAYS * 100.0;
+    result.volatility = std::sqrt(std::max(dot(w, sw), 0.0) * TRADING_DAYS) * 100.0;
+    result.sharpeRatio = result.volatility > 0 ? result.expectedReturn / result.volatility : 0.0;
+    
+    // Risk contribution of sleeve i: w_i (Sw)_i / w'Sw
+    double var = dot(w, sw);
+    double lo = 0.0, hi = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double share = var > 0 ? w[i] * sw[i] / var : 0.0;
+        lo = i == 0 ? share : std::min(lo, share);
+        hi = i == 0 ? share : std::max(hi, share);
+    }
+    result.riskSpread = (hi - lo) * 100.0;
+    result.iterations = iterations;
+    return result;
+}
+
+PortfolioWeights PortfolioOptimizer::minimumVariance(const PortfolioConstraints& c) const {
+    std::vector<double> w(n, 1.0 / n);
+    project(w, c);
+    
+    double lipschitz = 2.0 * largestEigenvalue();
+    if (lipschitz <= 0.0) return summarize(w, 0);
+    double step = 1.0 / lipschitz;
+    
+    // FISTA: gradient of w'Sw is 2Sw
+    std::vector<double> z = w, next(n), grad;
+    double t = 1.0;
+    int it = 0;
+    for (; it < c.maxIterations; it++) {
+        multiply(z, grad);
+        for (size_t i = 0; i < n; i++) next[i] = z[i] - step * 2.0 * grad[i];
+        project(next, c);
+        
+        double tNext = 0.5 * (1.0 + std::sqrt(1.0 + 4.0 * t * t));
+        double momentum = (t - 1.0) / tNext;
+        double change = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            double d = next[i] - w[i];
+            change = std::max(change, std::fabs(d));
+            z[i] = next[i] + momentum * d;
+        }
+        w.swap(next);
+        t = tNext;
+        if (change < c.tolerance) break;
+    }
+    
+    return summarize(w, it);
+}
+
+PortfolioWeights PortfolioOptimizer::riskParity(const PortfolioConstraints& c) const {
+    // Minimize 0.5 w'Sw - sum(b ln w) with b = 1/n; the normalized minimizer has
+    // equal risk contributions. Each coordinate update is a closed-form quadratic root.
+    // The weight bounds apply to the normalized weights w / sum(w), so each update
+    // is clamped to [minWeight, maxWeight] * sum(w); at the fixed point the free
+    // sleeves have equal risk contributions and the clamped ones sit on a bound.
+    double budget = 1.0 / n;
+    std::vector<double> w(n);
+    for (size_t i = 0; i < n; i++) w[i] = 1.0 / std::sqrt(cov[i * n + i]);
+    double total = std::accumulate(w.begin(), w.end(), 0.0);
+    for (double& v : w) v /= total;
+    project(w, c);   // Rejects infeasible bounds and starts inside them
+    total = 1.0;
+    
+    std::vector<double> sw;
+    multiply(w, sw);
+    
+    int it = 0;
+    for (; it < c.maxIterations; it++) {
+        double change = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            double sii = cov[i * n + i];
+            double ci = sw[i] - sii * w[i];
+            double wi = (-ci + std::sqrt(ci * ci + 4.0 * sii * budget)) / (2.0 * sii);
+            wi = std::min(std::max(wi, c.minWeight * total), c.maxWeight * total);
+            double delta = wi - w[i];
+            if (delta != 0.0) {
+                const double* __restrict__ row = &cov[i * n];
+                double* __restrict__ out = sw.data();
+                for (size_t j = 0; j < n; j++) out[j] += delta * row[j];
+                change = std::max(change, std::fabs(delta) / std::max(wi, w[i]));
+                total += delta;
+                w[i] = wi;
+            }
+        }
+        if (change < c.tolerance) break;
+    }
+    
+    total = std::accumulate(w.begin(), w.end(), 0.0);
+    for (double& v : w) v /= total;
+    
+    // Removes the rounding left by normalizing; the iteration already respects the bounds
+    project(w, c);
+    return summarize(w, it);
+}
+
+PortfolioWeights PortfolioOptimizer::maxSharpe(const PortfolioConstraints& c) const {
+    // With no positive expected return the tangency portfolio is undefined
+    if (*std::max_element(mean.begin(), mean.end()) <= 0.0) {
+        return minimumVariance(c);
+    }
+    
+    auto sharpe = [&](const std::vector<double>& w, std::vector<double>& sw) {
+        multiply(w, sw);
+        double var = dot(w, sw);
+        return var > 0 ? dot(w, mean) / std::sqrt(var) : 0.0;
+    };
+    
+    std::vector<double> w(n, 1.0 / n), sw, grad(n), candidate(n), swCandidate;
+    project(w, c);
+    double f = sharpe(w, sw);
+    double step = 0.0;
+    
+    int it = 0;
+    for (; it < c.maxIterations; it++) {
+        // d/dw (w'mu / sigma) = mu / sigma - (w'mu) Sw / sigma^3
+        double var = dot(w, sw);
+        double sigma = std::sqrt(var);
+        double ret = dot(w, mean);
+        double gmax = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            grad[i] = mean[i] / sigma - ret * sw[i] / (var * sigma);
+            gmax = std::max(gmax, std::fabs(grad[i]));
+        }
+        if (gmax == 0.0) break;
+        if (step == 0.0) step = 0.1 / gmax;
+        
+        // Backtracking: shrink until the projected step improves the ratio
+        bool improved = false;
+        double fCandidate = f;
+        while (step * gmax > 1e-14) {
+            for (size_t i = 0; i < n; i++) candidate[i] = w[i] + step * grad[i];
+            project(candidate, c);
+            fCandidate = sharpe(candidate, swCandidate);
+            if (fCandidate > f) {
+                improved = true;
+                break;
+            }
+            step *= 0.5;
+        }
+        if (!improved) break;
+        
+        double change = 0.0;
+        for (size_t i = 0; i < n; i++) change = std::max(change, std::fabs(candidate[i] - w[i]));
+        w.swap(candidate);
+        sw.swap(swCandidate);
+        double gain = fCandidate - f;
+        f = fCandidate;
+        step *= 2.0;
+        if (change < c.tolerance || gain < c.tolerance * std::fabs(f)) break;
+    }
+    
+    return summarize(w, it);
+}
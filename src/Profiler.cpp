@@ -0,0 +1,277 @@
+#include "../include/Profiler.hpp"
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <cmath>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+using namespace std;
+
+namespace {
+struct StageCounters {
+    atomic<uint64_t> calls{0};
+    atomic<uint64_t> totalNs{0};
+    atomic<uint64_t> items{0};
+    atomic<uint64_t> minNs{UINT64_MAX};
+    atomic<uint64_t> maxNs{0};
+    atomic<uint64_t> histogram[Profiler::HISTOGRAM_BUCKETS];
+    atomic<uint64_t> perf[NUM_PERF_EVENTS];
+    atomic<uint32_t> perfMask{0};
+};
+
+atomic<bool> profilingEnabled{false};
+atomic<bool> countersOn{false};
+StageCounters counters[NUM_PROFILE_STAGES];
+
+// Log-linear buckets: values below 4 get their own bucket, then each power
+// of two is split into 4 by the two bits below the leading one
+int bucketOf(uint64_t ns) {
+    if (ns < 4) return static_cast<int>(ns);
+    int msb = 63;
+    while (!(ns >> msb)) msb--;
+    return 4 * (msb - 1) + static_cast<int>((ns >> (msb - 2)) & 3);
+}
+
+void bucketRange(int b, double& lo, double& hi) {
+    if (b < 4) {
+        lo = b;
+        hi = b + 1;
+        return;
+    }
+    int shift = b / 4 - 1;
+    lo = ldexp(4 + b % 4, shift);
+    hi = ldexp(5 + b % 4, shift);
+}
+
+// Quantile from the histogram, interpolated inside the bucket and clamped
+// to the observed range
+double histogramQuantile(const StageCounters& c, uint64_t total, double q) {
+    if (total == 0) return 0.0;
+    double minNs = static_cast<double>(c.minNs.load(memory_order_relaxed));
+    double maxNs = static_cast<double>(c.maxNs.load(memory_order_relaxed));
+    double target = q * total;
+    double seen = 0.0;
+    for (int b = 0; b < Profiler::HISTOGRAM_BUCKETS; b++) {
+        double n = static_cast<double>(c.histogram[b].load(memory_order_relaxed));
+        if (n > 0 && seen + n >= target) {
+            double lo, hi;
+            bucketRange(b, lo, hi);
+            double v = lo + (hi - lo) * (target - seen) / n;
+            return min(max(v, minNs), maxNs);
+        }
+        seen += n;
+    }
+    return maxNs;
+}
+
+string formatRate(double perSecond) {
+    char buf[32];
+    if (perSecond >= 1e9) snprintf(buf, sizeof(buf), "%.2fG", perSecond / 1e9);
+    else if (perSecond >= 1e6) snprintf(buf, sizeof(buf), "%.2fM", perSecond / 1e6);
+    else if (perSecond >= 1e3) snprintf(buf, sizeof(buf), "%.2fK", perSecond / 1e3);
+    else snprintf(buf, sizeof(buf), "%.0f", perSecond);
+    return buf;
+}
+
+string formatBytes(double bytes) {
+    char buf[32];
+    if (bytes >= 1 << 30) snprintf(buf, sizeof(buf), "%.2f GiB", bytes / (1 << 30));
+    else if (bytes >= 1 << 20) snprintf(buf, sizeof(buf), "%.2f MiB", bytes / (1 << 20));
+    else if (bytes >= 1 << 10) snprintf(buf, sizeof(buf), "%.2f KiB", bytes / (1 << 10));
+    else snprintf(buf, sizeof(buf), "%.0f B", bytes);
+    return buf;
+}
+
+// Ratio as a percentage column, "-" when the events were not counted
+string formatPercent(double ratio) {
+    if (std::isnan(ratio)) return "-";
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.2f%%", 100.0 * ratio);
+    return buf;
+}
+}
+
+void Profiler::enable(bool on) {
+    profilingEnabled.store(on, memory_order_relaxed);
+}
+
+bool Profiler::enabled() {
+    return profilingEnabled.load(memory_order_relaxed);
+}
+
+void Profiler::enableCounters(bool on) {
+    countersOn.store(on, memory_order_relaxed);
+}
+
+bool Profiler::countersEnabled() {
+    return countersOn.load(memory_order_relaxed);
+}
+
+void Profiler::record(ProfileStage stage, uint64_t ns, uint64_t items,
+                      const PerfCounts* perf) {
+    StageCounters& c = counters[stage];
+    c.calls.fetch_add(1, memory_order_relaxed);
+    c.totalNs.fetch_add(ns, memory_order_relaxed);
+    c.items.fetch_add(items, memory_order_relaxed);
+    c.histogram[bucketOf(ns)].fetch_add(1, memory_order_relaxed);
+    uint64_t prev = c.maxNs.load(memory_order_relaxed);
+    while (ns > prev && !c.maxNs.compare_exchange_weak(prev, ns, memory_order_relaxed)) {
+    }
+    prev = c.minNs.load(memory_order_relaxed);
+    while (ns < prev && !c.minNs.compare_exchange_weak(prev, ns, memory_order_relaxed)) {
+    }
+    if (perf) {
+        for (int e = 0; e < NUM_PERF_EVENTS; e++) c.perf[e].fetch_add(perf->value[e], memory_order_relaxed);
+        c.perfMask.fetch_or(perf->validMask, memory_order_relaxed);
+    }
+}
+
+StageStats Profiler::stats(ProfileStage stage) {
+    const StageCounters& c = counters[stage];
+    StageStats s;
+    s.calls = c.calls.load(memory_order_relaxed);
+    s.totalNs = c.totalNs.load(memory_order_relaxed);
+    s.items = c.items.load(memory_order_relaxed);
+    s.maxNs = c.maxNs.load(memory_order_relaxed);
+    s.minNs = s.calls > 0 ? c.minNs.load(memory_order_relaxed) : 0;
+    s.p50Ns = histogramQuantile(c, s.calls, 0.50);
+    s.p99Ns = histogramQuantile(c, s.calls, 0.99);
+    for (int e = 0; e < NUM_PERF_EVENTS; e++) s.counters.value[e] = c.perf[e].load(memory_order_relaxed);
+    s.counters.validMask = c.perfMask.load(memory_order_relaxed);
+    return s;
+}
+
+void Profiler::reset() {
+    for (auto& c : counters) {
+        c.calls = 0;
+        c.totalNs = 0;
+        c.items = 0;
+        c.minNs = UINT64_MAX;
+        c.maxNs = 0;
+        for (auto& b : c.histogram) b = 0;
+        for (auto& p : c.perf) p = 0;
+        c.perfMask = 0;
+    }
+}
+
+const char* Profiler::stageName(ProfileStage stage) {
+    switch (stage) {
+        case STAGE_PARSE: return "parse";
+        case STAGE_INDICATORS: return "indicators";
+        case STAGE_LOOP: return "loop";
+        case STAGE_METRICS: return "metrics";
+        case STAGE_EXPORT: return "export";
+        default: return "unknown";
+    }
+}
+
+void Profiler::printReport(double wallSeconds) {
+    StageStats all[NUM_PROFILE_STAGES];
+    uint64_t sumNs = 0;
+    for (int s = 0; s < NUM_PROFILE_STAGES; s++) {
+        all[s] = stats(static_cast<ProfileStage>(s));
+        sumNs += all[s].totalNs;
+    }
+
+    cout << "\n=== PROFILE ===\n";
+    cout << left << setw(12) << "Stage"
+         << right << setw(8) << "Calls"
+         << setw(12) << "Total ms"
+         << setw(8) << "Share"
+         << setw(11) << "p50 us"
+         << setw(11) << "p99 us"
+         << setw(11) << "Max us"
+         << setw(12) << "Bars/s" << "\n";
+    cout << string(85, '-') << "\n";
+
+    string summary;
+    for (int s = 0; s < NUM_PROFILE_STAGES; s++) {
+        const StageStats& st = all[s];
+        if (st.calls == 0) continue;
+        double share = sumNs > 0 ? 100.0 * st.totalNs / sumNs : 0.0;
+        double seconds = st.totalNs * 1e-9;
+        cout << left << setw(12) << stageName(static_cast<ProfileStage>(s))
+             << right << setw(8) << st.calls
+             << fixed << setprecision(2)
+             << setw(12) << st.totalNs / 1e6
+             << setw(7) << setprecision(1) << share << "%"
+             << setprecision(1)
+             << setw(11) << st.p50Ns / 1e3
+             << setw(11) << st.p99Ns / 1e3
+             << setw(11) << st.maxNs / 1e3
+             << setw(12) << (st.items > 0 && seconds > 0 ? formatRate(st.items / seconds) : string("-"))
+             << "\n";
+
+        char part[64];
+        snprintf(part, sizeof(part), "%s%s %.0f%%", summary.empty() ? "" : ", ",
+                 stageName(static_cast<ProfileStage>(s)), share);
+        summary += part;
+    }
+
+    if (summary.empty()) {
+        cout << "(no timed stages)\n";
+        return;
+    }
+    
+    if (countersEnabled()) {
+        cout << "\n" << left << setw(12) << "Stage"
+             << right << setw(10) << "IPC"
+             << setw(12) << "Cycles/bar"
+             << setw(11) << "L1D miss"
+             << setw(11) << "LLC miss"
+             << setw(11) << "Br miss" << "\n";
+        cout << string(67, '-') << "\n";
+        for (int s = 0; s < NUM_PROFILE_STAGES; s++) {
+            const StageStats& st = all[s];
+            if (st.calls == 0 || st.counters.validMask == 0) continue;
+            const PerfCounts& pc = st.counters;
+            cout << left << setw(12) << stageName(static_cast<ProfileStage>(s)) << right;
+            if (std::isnan(pc.ipc())) cout << setw(10) << "-";
+            else cout << setw(10) << setprecision(2) << pc.ipc();
+            if (st.items > 0 && pc.has(PERF_CYCLES)) {
+                cout << setw(12) << setprecision(1) << static_cast<double>(pc.value[PERF_CYCLES]) / st.items;
+            } else {
+                cout << setw(12) << "-";
+            }
+            cout << setw(11) << formatPercent(pc.l1MissRate())
+                 << setw(11) << formatPercent(pc.llcMissRate())
+                 << setw(11) << formatPercent(pc.branchMissRate()) << "\n";
+        }
+    } else if (!PerfCounters::available()) {
+        cout << "\nHardware counters unavailable: " << PerfCounters::unavailableReason() << "\n";
+    }
+    
+    if (AllocTracker::enabled()) {
+        cout << "\n" << left << setw(12) << "Stage"
+             << right << setw(12) << "Allocs"
+             << setw(14) << "Bytes"
+             << setw(12) << "Frees"
+             << setw(12) << "Allocs/bar"
+             << setw(12) << "Bytes/bar" << "\n";
+        cout << string(74, '-') << "\n";
+        for (int s = AllocTracker::OTHER_STAGE; s < NUM_PROFILE_STAGES; s++) {
+            AllocStats a = AllocTracker::stats(s);
+            uint64_t items = s >= 0 ? all[s].items : 0;
+            if (a.allocations == 0 && a.frees == 0) continue;
+            cout << left << setw(12) << (s >= 0 ? stageName(static_cast<ProfileStage>(s)) : "other")
+                 << right << setw(12) << a.allocations
+                 << setw(14) << formatBytes(static_cast<double>(a.bytes))
+                 << setw(12) << a.frees;
+            if (items > 0) {
+                cout << setw(12) << setprecision(3) << static_cast<double>(a.allocations) / items
+                     << setw(12) << setprecision(1) << static_cast<double>(a.bytes) / items;
+            } else {
+                cout << setw(12) << "-" << setw(12) << "-";
+            }
+            cout << "\n";
+        }
+        cout << "Heap high-water " << formatBytes(static_cast<double>(AllocTracker::peakLiveBytes()))
+             << ", live at exit " << formatBytes(static_cast<double>(AllocTracker::liveBytes())) << "\n";
+    }
+    
+    cout << "\n" << summary << "  (" << setprecision(1) << sumNs / 1e6 << " ms timed, "
+         << wallSeconds * 1e3 << " ms wall, peak RSS "
+         << formatBytes(static_cast<double>(AllocTracker::peakRssBytes())) << ")\n";
+}
@@ -0,0 +1,175 @@
+#include "../include/RandomStream.hpp"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+const uint32_t PHILOX_M0 = 0xD2511F53u;
+const uint32_t PHILOX_M1 = 0xCD9E8D57u;
+const uint32_t PHILOX_W0 = 0x9E3779B9u;
+const uint32_t PHILOX_W1 = 0xBB67AE85u;
+const int PHILOX_ROUNDS = 10;
+
+// Blocks evaluated side by side
+const size_t LANES = 16;
+const size_t CHUNK_BLOCKS = 256;
+
+const double TWO_POW_M53 = 1.0 / 9007199254740992.0;
+const double TWO_PI = 6.283185307179586476925286766559;
+
+// Ten Philox rounds over LANES independent counters (structure-of-arrays so
+// each round is one vectorized widening multiply per word pair)
+void philoxLanes(uint32_t* __restrict__ x0, uint32_t* __restrict__ x1,
+                 uint32_t* __restrict__ x2, uint32_t* __restrict__ x3,
+                 uint32_t k0, uint32_t k1) {
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+        for (size_t l = 0; l < LANES; l++) {
+            uint64_t p0 = static_cast<uint64_t>(PHILOX_M0) * x0[l];
+            uint64_t p1 = static_cast<uint64_t>(PHILOX_M1) * x2[l];
+            uint32_t y0 = static_cast<uint32_t>(p1 >> 32) ^ x1[l] ^ k0;
+            uint32_t y2 = static_cast<uint32_t>(p0 >> 32) ^ x3[l] ^ k1;
+            x0[l] = y0;
+            x1[l] = static_cast<uint32_t>(p1);
+            x2[l] = y2;
+            x3[l] = static_cast<uint32_t>(p0);
+        }
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+}
+
+inline uint64_t joinWords(uint32_t hi, uint32_t lo) {
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+
+// [0, 1) with 53 random bits
+inline double toUniform(uint32_t hi, uint32_t lo) {
+    return (joinWords(hi, lo) >> 11) * TWO_POW_M53;
+}
+
+// (0, 1], safe for log()
+inline double toUniformOpen(uint32_t hi, uint32_t lo) {
+    return ((joinWords(hi, lo) >> 11) + 1) * TWO_POW_M53;
+}
+}
+
+RandomStream::RandomStream(uint64_t seed, uint32_t jobId, uint32_t streamId)
+    : job(jobId), stream(streamId), pos(0) {
+    key[0] = static_cast<uint32_t>(seed);
+    key[1] = static_cast<uint32_t>(seed >> 32);
+}
+
+void RandomStream::philox(const uint32_t counter[4], const uint32_t keyIn[2], uint32_t out[4]) {
+    uint32_t x0 = counter[0], x1 = counter[1], x2 = counter[2], x3 = counter[3];
+    uint32_t k0 = keyIn[0], k1 = keyIn[1];
+    
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+        uint64_t p0 = static_cast<uint64_t>(PHILOX_M0) * x0;
+        uint64_t p1 = static_cast<uint64_t>(PHILOX_M1) * x2;
+        uint32_t y0 = static_cast<uint32_t>(p1 >> 32) ^ x1 ^ k0;
+        uint32_t y2 = static_cast<uint32_t>(p0 >> 32) ^ x3 ^ k1;
+        x0 = y0;
+        x1 = static_cast<uint32_t>(p1);
+        x2 = y2;
+        x3 = static_cast<uint32_t>(p0);
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    
+    out[0] = x0; out[1] = x1; out[2] = x2; out[3] = x3;
+}
+
+void RandomStream::blocks(uint64_t first, size_t count, uint32_t* out) const {
+    // Single draws skip the lane setup
+    if (count == 1) {
+        uint32_t counter[4] = {static_cast<uint32_t>(first), static_cast<uint32_t>(first >> 32), stream, job};
+        philox(counter, key, out);
+        return;
+    }
+    
+    for (size_t b = 0; b < count; b += LANES) {
+        uint32_t x0[LANES], x1[LANES], x2[LANES], x3[LANES];
+        for (size_t l = 0; l < LANES; l++) {
+            uint64_t ctr = first + b + l;
+            x0[l] = static_cast<uint32_t>(ctr);
+            x1[l] = static_cast<uint32_t>(ctr >> 32);
+            x2[l] = stream;
+            x3[l] = job;
+        }
+        
+        philoxLanes(x0, x1, x2, x3, key[0], key[1]);
+        
+        size_t lanes = std::min(LANES, count - b);
+        for (size_t l = 0; l < lanes; l++) {
+            uint32_t* o = out + 4 * (b + l);
+            o[0] = x0[l]; o[1] = x1[l]; o[2] = x2[l]; o[3] = x3[l];
+        }
+    }
+}
+
+template <bool Normal>
+void RandomStream::generate(double* out, size_t count) {
+    uint32_t words[4 * CHUNK_BLOCKS];
+    
+    auto convert = [](const uint32_t* w, double* pair) {
+        if (Normal) {
+            double radius = std::sqrt(-2.0 * std::log(toUniformOpen(w[0], w[1])));
+            double angle = TWO_PI * toUniform(w[2], w[3]);
+            pair[0] = radius * std::cos(angle);
+            pair[1] = radius * std::sin(angle);
+        } else {
+            pair[0] = toUniform(w[0], w[1]);
+            pair[1] = toUniform(w[2], w[3]);
+        }
+    };
+    
+    // Leading half block when the stream sits on an odd draw
+    if (count > 0 && pos % 2 == 1) {
+        double pair[2];
+        blocks(pos / 2, 1, words);
+        convert(words, pair);
+        *out++ = pair[1];
+        pos++;
+        count--;
+    }
+    
+    // Whole blocks convert straight into the output
+    while (count >= 2) {
+        size_t numBlocks = std::min(CHUNK_BLOCKS, count / 2);
+        blocks(pos / 2, numBlocks, words);
+        for (size_t b = 0; b < numBlocks; b++) {
+            convert(words + 4 * b, out + 2 * b);
+        }
+        out += 2 * numBlocks;
+        pos += 2 * numBlocks;
+        count -= 2 * numBlocks;
+    }
+    
+    // Trailing half block
+    if (count == 1) {
+        double pair[2];
+        blocks(pos / 2, 1, words);
+        convert(words, pair);
+        *out = pair[0];
+        pos++;
+    }
+}
+
+void RandomStream::uniform(double* out, size_t count) {
+    generate<false>(out, count);
+}
+
+void RandomStream::normal(double* out, size_t count) {
+    generate<true>(out, count);
+}
+
+double RandomStream::nextUniform() {
+    double v;
+    generate<false>(&v, 1);
+    return v;
+}
+
+double RandomStream::nextNormal() {
+    double v;
+    generate<true>(&v, 1);
+    return v;
+}
@@ -0,0 +1,74 @@
+#include "../include/RegimeDetector.hpp"
+#include <cmath>
+#include <algorithm>
+
+// Rolling volatility and efficiency ratio are maintained with running sums,
+// so labelling is O(n) plus one O(n) median selection.
+std::vector<int> RegimeDetector::label(const std::vector<double>& closes,
+                                       int volPeriod,
+                                       int trendPeriod,
+                                       double trendThreshold) {
+    size_t n = closes.size();
+    std::vector<int> labels(n, REGIME_LOWVOL_CHOP);
+    size_t warmup = static_cast<size_t>(std::max(volPeriod, trendPeriod));
+    if (n <= warmup || volPeriod < 2 || trendPeriod < 1) return labels;
+    
+    std::vector<double> vol(n, 0.0);
+    std::vector<double> efficiency(n, 0.0);
+    std::vector<double> logRet(n, 0.0);
+    std::vector<double> absMove(n, 0.0);
+    
+    double sum = 0.0, sumSq = 0.0, path = 0.0;
+    for (size_t i = 1; i < n; i++) {
+        double r = (closes[i] > 0 && closes[i - 1] > 0) ? std::log(closes[i] / closes[i - 1]) : 0.0;
+        logRet[i] = r;
+        absMove[i] = std::fabs(closes[i] - closes[i - 1]);
+        
+        sum += r;
+        sumSq += r * r;
+        path += absMove[i];
+        if (i > static_cast<size_t>(volPeriod)) {
+            double old = logRet[i - volPeriod];
+            sum -= old;
+            sumSq -= old * old;
+        }
+        if (i > static_cast<size_t>(trendPeriod)) {
+            path -= absMove[i - trendPeriod];
+        }
+        
+        if (i >= static_cast<size_t>(volPeriod)) {
+            double mean = sum / volPeriod;
+            double var = sumSq / volPeriod - mean * mean;
+            vol[i] = var > 0.0 ? std::sqrt(var) : 0.0;
+        }
+        if (i >= static_cast<size_t>(trendPeriod)) {
+            double net = std::fabs(closes[i] - closes[i - trendPeriod]);
+            efficiency[i] = path > 0.0 ? net / path : 0.0;
+        }
+    }
+    
+    // Median volatility over the labelled range splits high/low
+    std::vector<double> sample(vol.begin() + warmup, vol.end());
+    auto mid = sample.begin() + sample.size() / 2;
+    std::nth_element(sample.begin(), mid, sample.end());
+    double medianVol = *mid;
+    
+    for (size_t i = warmup; i < n; i++) {
+        int highVol = vol[i] > medianVol ? 1 : 0;
+        int trending = efficiency[i] > trendThreshold ? 1 : 0;
+        labels[i] = highVol * 2 + trending;
+    }
+    std::fill(labels.begin(), labels.begin() + warmup, labels[warmup]);
+    
+    return labels;
+}
+
+const char* RegimeDetector::name(int regime) {
+    switch (regime) {
+        case REGIME_LOWVOL_CHOP: return "Low Vol / Chop";
+        case REGIME_LOWVOL_TREND: return "Low Vol / Trend";
+        case REGIME_HIGHVOL_CHOP: return "High Vol / Chop";
+        case REGIME_HIGHVOL_TREND: return "High Vol / Trend";
+        default: return "Unknown";
+    }
+}
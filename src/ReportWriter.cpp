@@ -0,0 +1,95 @@
+#include "../include/ReportWriter.hpp"
+#include <charconv>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+using namespace std;
+
+namespace {
+// Longest fixed-notation double before the decimals: sign + 309 digits + point
+const size_t MAX_FIXED_CHARS = 320;
+}
+
+ReportWriter::ReportWriter(const string& filename, size_t bufferSize)
+    : file(filename == "-" ? stdout : fopen(filename.c_str(), "wb")),
+      ownsFile(filename != "-"),
+      failed(file == nullptr),
+      buffer(max(bufferSize, MAX_FIXED_CHARS * 2)),
+      used(0) {
+    if (file && ownsFile) {
+        // Our buffer already batches writes; skip stdio's copy
+        setvbuf(file, nullptr, _IONBF, 0);
+    }
+}
+
+ReportWriter::~ReportWriter() {
+    close();
+}
+
+bool ReportWriter::close() {
+    if (file) {
+        flush();
+        if (ownsFile) {
+            if (fclose(file) != 0) failed = true;
+        } else if (fflush(file) != 0 || ferror(file)) {
+            failed = true;
+        }
+        file = nullptr;
+    }
+    return !failed;
+}
+
+ReportWriter& ReportWriter::text(const char* s, size_t n) {
+    if (n > buffer.size()) {
+        flush();
+        if (file && fwrite(s, 1, n, file) != n) failed = true;
+        return *this;
+    }
+    reserve(n);
+    memcpy(buffer.data() + used, s, n);
+    used += n;
+    return *this;
+}
+
+ReportWriter& ReportWriter::text(const char* s) {
+    return text(s, strlen(s));
+}
+
+ReportWriter& ReportWriter::put(char c) {
+    reserve(1);
+    buffer[used++] = c;
+    return *this;
+}
+
+ReportWriter& ReportWriter::fixed(double value, int precision) {
+    reserve(MAX_FIXED_CHARS + precision);
+    char* begin = buffer.data() + used;
+    char* end = buffer.data() + buffer.size();
+    
+    // iostreams print NaN/inf via printf, which to_chars matches ("nan", "-nan", "inf")
+    auto res = to_chars(begin, end, value, chars_format::fixed, precision);
+    used = res.ptr - buffer.data();
+    return *this;
+}
+
+ReportWriter& ReportWriter::shortest(double value) {
+    reserve(32);
+    auto res = to_chars(buffer.data() + used, buffer.data() + buffer.size(), value);
+    used = res.ptr - buffer.data();
+    return *this;
+}
+
+ReportWriter& ReportWriter::integer(long long value) {
+    reserve(24);
+    auto res = to_chars(buffer.data() + used, buffer.data() + buffer.size(), value);
+    used = res.ptr - buffer.data();
+    return *this;
+}
+
+void ReportWriter::flush() {
+    if (file && used > 0 && fwrite(buffer.data(), 1, used, file) != used) {
+        failed = true;
+    }
+    used = 0;
+}
@@ -0,0 +1,233 @@
+#include "../include/ResultCache.hpp"
+#include "../include/MappedFile.hpp"
+#include "../include/BinaryResultReader.hpp"
+#include "../include/ResultExport.hpp"
+#include "../include/ReportWriter.hpp"
+#include "../include/RuntimeMetrics.hpp"
+#include <filesystem>
+#include <fstream>
+#include <charconv>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+using namespace std;
+
+namespace {
+uint64_t mix(uint64_t x) {
+    x ^= x >> 32;
+    x *= 0xD6E8FEB86659FD93ULL;
+    x ^= x >> 32;
+    x *= 0xD6E8FEB86659FD93ULL;
+    x ^= x >> 32;
+    return x;
+}
+
+string hex16(uint64_t value) {
+    static const char digits[] = "0123456789abcdef";
+    string s(16, '0');
+    for (int i = 15; i >= 0; i--, value >>= 4) {
+        s[i] = digits[value & 15];
+    }
+    return s;
+}
+
+void appendDouble(string& s, const char* name, double value) {
+    char buf[32];
+    auto res = to_chars(buf, buf + sizeof(buf), value);
+    s.append(name).append("=").append(buf, res.ptr).append(";");
+}
+
+void appendInt(string& s, const char* name, long long value) {
+    s.append(name).append("=").append(to_string(value)).append(";");
+}
+
+// Unique per process, so writers racing on one key never share a temp file
+string tempName(const string& path) {
+    return path + ".tmp" + to_string(getpid());
+}
+
+void readStats(const string& path, uint64_t& hits, uint64_t& misses) {
+    hits = misses = 0;
+    ifstream in(path);
+    string name;
+    uint64_t value;
+    while (in >> name >> value) {
+        if (name == "hits") hits = value;
+        else if (name == "misses") misses = value;
+    }
+}
+}
+
+ResultCache::ResultCache(const string& directory)
+    : dir(directory), totalHits(0), totalMisses(0), newHits(0), newMisses(0) {
+    error_code ec;
+    filesystem::create_directories(filesystem::path(dir) / "objects", ec);
+    filesystem::create_directories(filesystem::path(dir) / "manifests", ec);
+    if (ec) {
+        throw runtime_error("Cannot create cache directory " + dir);
+    }
+    readStats(dir + "/stats", totalHits, totalMisses);
+}
+
+ResultCache::~ResultCache() {
+    saveStats();
+}
+
+uint64_t ResultCache::checksum(const char* data, size_t n, uint64_t seed) {
+    // Word-at-a-time multiply/xorshift; not cryptographic, only needs to
+    // tell edited data files apart
+    uint64_t h = mix(seed ^ (n * 0x9E3779B97F4A7C15ULL));
+    if (n == 0) return mix(h);   // data may be null; same value as the tail path
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        memcpy(&w, data + i, 8);
+        h = mix(h ^ w) + 0x9E3779B97F4A7C15ULL;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data + i, n - i);
+    return mix(h ^ tail ^ (n - i));
+}
+
+string ResultCache::canonicalParams(const BacktestConfig& c) {
+    // Shortest round-trip doubles: any change to a parameter changes the string
+    string s;
+    appendInt(s, "short", c.shortMA);
+    appendInt(s, "long", c.longMA);
+    appendDouble(s, "capital", c.initialCapital);
+    appendInt(s, "rsi", c.useRSI);
+    appendInt(s, "ema", c.useEMA);
+    appendInt(s, "macd", c.useMACD);
+    appendInt(s, "bollinger", c.useBollinger);
+    appendDouble(s, "stoploss", c.stopLoss);
+    appendDouble(s, "takeprofit", c.takeProfit);
+    appendDouble(s, "commission", c.commission);
+    appendInt(s, "kelly", c.useKelly);
+    appendDouble(s, "slippage", c.slippage);
+    return s;
+}
+
+CacheKey ResultCache::makeKey(const string& dataFile, const BacktestConfig& config) {
+    CacheKey key;
+    MappedFile data(dataFile);
+    key.dataFile = dataFile;
+    key.dataBytes = data.size();
+    key.dataChecksum = checksum(data.data(), data.size());
+    key.params = canonicalParams(config);
+    
+    string identity = string(ENGINE_VERSION) + "|" + hex16(key.dataChecksum) + "|" + key.params;
+    key.id = hex16(checksum(identity.data(), identity.size(), key.dataBytes));
+    return key;
+}
+
+string ResultCache::objectPath(const CacheKey& key) const {
+    return dir + "/objects/" + key.id + ".btr";
+}
+
+string ResultCache::manifestPath(const CacheKey& key) const {
+    return dir + "/manifests/" + key.id + ".txt";
+}
+
+bool ResultCache::load(const CacheKey& key, BacktestResult& result) {
+    string path = objectPath(key);
+    error_code ec;
+    if (filesystem::exists(path, ec)) {
+        try {
+            BacktestResult stored = BinaryResultReader(path).toResult(true);
+            // The id is a 64-bit hash: only serve a result simulated with
+            // exactly these parameters
+            if (canonicalParams(stored.config) != key.params) {
+                throw runtime_error("Cache entry parameters do not match");
+            }
+            result = move(stored);
+            totalHits++;
+            newHits++;
+            RuntimeMetrics::add(METRIC_CACHE_HITS);
+            return true;
+        } catch (const exception&) {
+            // Truncated, foreign or colliding file: drop it and re-simulate
+            filesystem::remove(path, ec);
+        }
+    }
+    totalMisses++;
+    newMisses++;
+    RuntimeMetrics::add(METRIC_CACHE_MISSES);
+    return false;
+}
+
+bool ResultCache::store(const CacheKey& key, const BacktestResult& result) {
+    string object = objectPath(key);
+    string manifest = manifestPath(key);
+    string objectTemp = tempName(object);
+    string manifestTemp = tempName(manifest);
+    
+    // A short write (disk full) must never be renamed into the cache
+    error_code ec;
+    if (!ResultExport::writeBinary(objectTemp, result)) {
+        filesystem::remove(objectTemp, ec);
+        return false;
+    }
+    {
+        ReportWriter out(manifestTemp);
+        time_t now = time(nullptr);
+        char created[32];
+        strftime(created, sizeof(created), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+        
+        out.text("key ").text(key.id.c_str()).put('\n');
+        out.text("engine ").text(ENGINE_VERSION).put('\n');
+        out.text("data_file ").text(key.dataFile.c_str()).put('\n');
+        out.text("data_bytes ").integer(static_cast<long long>(key.dataBytes)).put('\n');
+        out.text("data_checksum ").text(hex16(key.dataChecksum).c_str()).put('\n');
+        out.text("params ").text(key.params.c_str()).put('\n');
+        out.text("bars ").integer(static_cast<long long>(result.equity.size())).put('\n');
+        out.text("trades ").integer(static_cast<long long>(result.trades.size())).put('\n');
+        out.text("created ").text(created).put('\n');
+        if (!out.close()) {
+            filesystem::remove(objectTemp, ec);
+            filesystem::remove(manifestTemp, ec);
+            return false;
+        }
+    }
+    
+    // Manifest first: an object is only visible once it is described
+    filesystem::rename(manifestTemp, manifest, ec);
+    if (!ec) filesystem::rename(objectTemp, object, ec);
+    if (ec) {
+        filesystem::remove(objectTemp, ec);
+        filesystem::remove(manifestTemp, ec);
+        return false;
+    }
+    return true;
+}
+
+void ResultCache::saveStats() {
+    if (newHits == 0 && newMisses == 0) return;
+    
+    // Re-read so counts from runs that finished meanwhile aren't overwritten
+    string path = dir + "/stats";
+    readStats(path, totalHits, totalMisses);
+    totalHits += newHits;
+    totalMisses += newMisses;
+    newHits = newMisses = 0;
+    
+    string temp = tempName(path);
+    bool written;
+    {
+        ReportWriter out(temp);
+        out.text("hits ").integer(static_cast<long long>(totalHits)).put('\n');
+        out.text("misses ").integer(static_cast<long long>(totalMisses)).put('\n');
+        written = out.close();
+    }
+    error_code ec;
+    if (!written) {
+        filesystem::remove(temp, ec);
+        return;
+    }
+    filesystem::rename(temp, path, ec);
+}
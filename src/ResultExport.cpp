@@ -0,0 +1,228 @@
+#include "../include/ResultExport.hpp"
+#include "../include/ReportWriter.hpp"
+#include "../include/BinaryResultFormat.hpp"
+#include <cstring>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+using namespace std;
+
+namespace {
+void copyDate(char (&dst)[BINARY_DATE_CHARS], const string& src) {
+    memset(dst, 0, BINARY_DATE_CHARS);
+    memcpy(dst, src.data(), min(src.size(), static_cast<size_t>(BINARY_DATE_CHARS)));
+}
+
+uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~static_cast<uint64_t>(7);
+}
+}
+
+void ResultExport::ensureParentDirectory(const string& filename) {
+    size_t slash = filename.find_last_of("/\\");
+    if (slash == string::npos || slash == 0) return;
+    string dir = filename.substr(0, slash);
+    #ifdef _WIN32
+        _mkdir(dir.c_str());
+    #else
+        mkdir(dir.c_str(), 0777);
+    #endif
+}
+
+bool ResultExport::writeCSV(const string& filename,
+                            double initialCapital,
+                            double finalValue,
+                            const PerformanceMetrics& metrics,
+                            const vector<Trade>& trades) {
+    ensureParentDirectory(filename);
+    ReportWriter file(filename);
+    if (!file.isOpen()) return false;
+    
+    file.text("BACKTEST SUMMARY\n");
+    file.text("================\n\n");
+    
+    file.text("Initial Capital,$").fixed(initialCapital, 2).put('\n');
+    file.text("Final Value,$").fixed(finalValue, 2).put('\n');
+    file.text("Total Return,").fixed(metrics.totalReturn, 2).text("%\n");
+    file.text("CAGR,").fixed(metrics.cagr, 2).text("%\n");
+    file.text("Max Drawdown,").fixed(metrics.maxDrawdown, 2).text("%\n");
+    file.text("Sharpe Ratio,").fixed(metrics.sharpeRatio, 3).put('\n');
+    file.text("Number of Trades,").integer(metrics.numTrades).put('\n');
+    file.text("Winning Trades,").integer(metrics.winningTrades).put('\n');
+    file.text("Win Rate,").fixed(metrics.winRate, 2).text("%\n");
+    file.text("Average Win,$").fixed(metrics.avgWin, 2).put('\n');
+    file.text("Average Loss,$").fixed(metrics.avgLoss, 2).put('\n');
+    file.text("Profit Factor,").fixed(metrics.profitFactor, 2).text("\n\n");
+    
+    file.text("TRADE LOG\n");
+    file.text("=========\n");
+    file.text("Entry Date,Exit Date,Entry Price,Exit Price,Shares,P&L,Return %\n");
+    
+    for (const auto& t : trades) {
+        file.text(t.entryDate).put(',').text(t.exitDate).put(',')
+            .fixed(t.entryPrice, 2).put(',').fixed(t.exitPrice, 2).put(',')
+            .fixed(t.shares, 4).put(',')
+            .fixed(t.pnl, 2).put(',')
+            .fixed(t.returnPct, 2).text("%\n");
+    }
+    return file.close();
+}
+
+bool ResultExport::writeCSV(const string& filename, const BacktestResult& result) {
+    return writeCSV(filename, result.config.initialCapital, result.finalValue,
+                    result.metrics, result.trades);
+}
+
+bool ResultExport::writeBinary(const string& filename, const BacktestResult& result) {
+    ensureParentDirectory(filename);
+    ReportWriter file(filename);
+    if (!file.isOpen()) return false;
+    
+    uint64_t numBars = result.equity.size();
+    
+    BinaryResultHeader h = {};
+    memcpy(h.magic, BINARY_RESULT_MAGIC, sizeof(h.magic));
+    h.major = BINARY_RESULT_MAJOR;
+    h.minor = BINARY_RESULT_MINOR;
+    h.headerSize = sizeof(BinaryResultHeader);
+    h.metricsSize = sizeof(BinaryMetrics);
+    h.tradeRecordSize = sizeof(BinaryTrade);
+    h.numTrades = result.trades.size();
+    h.numBars = numBars;
+    h.metricsOffset = align8(h.headerSize);
+    h.tradesOffset = align8(h.metricsOffset + h.metricsSize);
+    h.datesOffset = align8(h.tradesOffset + h.numTrades * h.tradeRecordSize);
+    h.equityOffset = align8(h.datesOffset + numBars * BINARY_DATE_CHARS);
+    h.positionOffset = h.equityOffset + numBars * sizeof(double);
+    h.fileSize = h.positionOffset + numBars * sizeof(double);
+    file.bytes(&h, sizeof(h));
+    
+    const BacktestConfig& c = result.config;
+    const PerformanceMetrics& m = result.metrics;
+    BinaryMetrics bm = {};
+    bm.shortMA = c.shortMA;
+    bm.longMA = c.longMA;
+    bm.flags = (c.useRSI ? 1u : 0u) | (c.useEMA ? 2u : 0u) | (c.useMACD ? 4u : 0u) |
+               (c.useBollinger ? 8u : 0u) | (c.useKelly ? 16u : 0u);
+    bm.initialCapital = c.initialCapital;
+    bm.stopLoss = c.stopLoss;
+    bm.takeProfit = c.takeProfit;
+    bm.commission = c.commission;
+    bm.slippage = c.slippage;
+    bm.finalValue = result.finalValue;
+    bm.totalReturn = m.totalReturn;
+    bm.cagr = m.cagr;
+    bm.maxDrawdown = m.maxDrawdown;
+    bm.sharpeRatio = m.sharpeRatio;
+    bm.numTrades = m.numTrades;
+    bm.winningTrades = m.winningTrades;
+    bm.winRate = m.winRate;
+    bm.avgWin = m.avgWin;
+    bm.avgLoss = m.avgLoss;
+    bm.profitFactor = m.profitFactor;
+    file.bytes(&bm, sizeof(bm));
+    
+    for (const auto& t : result.trades) {
+        BinaryTrade bt = {};
+        copyDate(bt.entryDate, t.entryDate);
+        copyDate(bt.exitDate, t.exitDate);
+        bt.entryPrice = t.entryPrice;
+        bt.exitPrice = t.exitPrice;
+        bt.shares = t.shares;
+        bt.pnl = t.pnl;
+        bt.returnPct = t.returnPct;
+        bt.entryIndex = t.entryIndex;
+        bt.exitIndex = t.exitIndex;
+        bt.exitReason = t.exitReason;
+        file.bytes(&bt, sizeof(bt));
+    }
+    
+    // Dates are fixed-width and a multiple of 8 bytes, so no padding is needed
+    for (uint64_t i = 0; i < numBars; i++) {
+        char date[BINARY_DATE_CHARS];
+        copyDate(date, i < result.dates.size() ? result.dates[i] : string());
+        file.bytes(date, sizeof(date));
+    }
+    file.bytes(result.equity.data(), numBars * sizeof(double));
+    
+    // Position column defaults to flat if the caller only supplied equity
+    if (result.position.size() == numBars) {
+        file.bytes(result.position.data(), numBars * sizeof(double));
+    } else {
+        vector<double> flat(numBars, 0.0);
+        file.bytes(flat.data(), numBars * sizeof(double));
+    }
+    return file.close();
+}
+
+bool ResultExport::writeJSON(const string& filename, const BacktestResult& result) {
+    ensureParentDirectory(filename);
+    ReportWriter file(filename);
+    if (!file.isOpen()) return false;
+    
+    JsonWriter json(file);
+    json.beginObject();
+    jsonFields(json, result, true);
+    json.endObject().endRecord();
+    return file.close();
+}
+
+void ResultExport::jsonFields(JsonWriter& json, const BacktestResult& result, bool includeTrades) {
+    json.key("config");
+    jsonConfig(json, result.config);
+    json.key("final_value").value(result.finalValue);
+    json.key("metrics");
+    jsonMetrics(json, result.metrics);
+    if (!includeTrades) return;
+    
+    static const char* REASONS[] = {"signal", "stop_loss", "take_profit", "end_of_data"};
+    json.key("trades").beginArray();
+    for (const auto& t : result.trades) {
+        json.beginObject()
+            .key("entry_date").value(t.entryDate)
+            .key("exit_date").value(t.exitDate)
+            .key("entry_price").value(t.entryPrice)
+            .key("exit_price").value(t.exitPrice)
+            .key("shares").value(t.shares)
+            .key("pnl").value(t.pnl)
+            .key("return_pct").value(t.returnPct)
+            .key("exit_reason").value(REASONS[t.exitReason])
+            .endObject();
+    }
+    json.endArray();
+}
+
+void ResultExport::jsonConfig(JsonWriter& json, const BacktestConfig& c) {
+    json.beginObject()
+        .key("short_ma").value(c.shortMA)
+        .key("long_ma").value(c.longMA)
+        .key("initial_capital").value(c.initialCapital)
+        .key("ema").value(c.useEMA)
+        .key("rsi").value(c.useRSI)
+        .key("macd").value(c.useMACD)
+        .key("bollinger").value(c.useBollinger)
+        .key("kelly").value(c.useKelly)
+        .key("stop_loss").value(c.stopLoss)
+        .key("take_profit").value(c.takeProfit)
+        .key("commission").value(c.commission)
+        .key("slippage").value(c.slippage)
+        .endObject();
+}
+
+void ResultExport::jsonMetrics(JsonWriter& json, const PerformanceMetrics& m) {
+    // Percent fields stay in percent, as in the CSV summary
+    json.beginObject()
+        .key("total_return_pct").value(m.totalReturn)
+        .key("cagr_pct").value(m.cagr)
+        .key("max_drawdown_pct").value(m.maxDrawdown)
+        .key("sharpe").value(m.sharpeRatio)
+        .key("num_trades").value(m.numTrades)
+        .key("winning_trades").value(m.winningTrades)
+        .key("win_rate_pct").value(m.winRate)
+        .key("avg_win").value(m.avgWin)
+        .key("avg_loss").value(m.avgLoss)
+        .key("profit_factor").value(m.profitFactor)
+        .endObject();
+}
@@ -0,0 +1,350 @@
+#include "../include/ResultStore.hpp"
+#include "../include/MappedFile.hpp"
+#include "../include/ResultExport.hpp"
+#include <fstream>
+#include <algorithm>
+#include <queue>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <stdexcept>
+using namespace std;
+
+namespace {
+// The last magic byte is the format version; 2 added the slippage column
+const char STORE_MAGIC[8] = {'B', 'T', 'S', 'T', 'O', 'R', 'E', '2'};
+const char INDEX_MAGIC[8] = {'B', 'T', 'I', 'N', 'D', 'E', 'X', '1'};
+
+struct StoreHeader {
+    char magic[8];
+    uint32_t numColumns;
+    uint32_t blockRows;
+    uint64_t count;
+    char reserved[40];
+};
+static_assert(sizeof(StoreHeader) == 64, "store header must stay 64 bytes");
+
+struct IndexHeader {
+    char magic[8];
+    uint32_t column;
+    uint32_t reserved;
+    uint64_t count;
+};
+
+const size_t BLOCK_BYTES = static_cast<size_t>(ResultStore::BLOCK_ROWS) * NUM_RESULT_COLUMNS * sizeof(double);
+
+enum ConfigFlags {
+    FLAG_RSI = 1,
+    FLAG_EMA = 2,
+    FLAG_MACD = 4,
+    FLAG_BOLLINGER = 8,
+    FLAG_KELLY = 16
+};
+
+size_t valueOffset(uint64_t row, int column) {
+    uint64_t blockIndex = row / ResultStore::BLOCK_ROWS;
+    uint64_t inBlock = row % ResultStore::BLOCK_ROWS;
+    return sizeof(StoreHeader) + blockIndex * BLOCK_BYTES +
+           (static_cast<size_t>(column) * ResultStore::BLOCK_ROWS + inBlock) * sizeof(double);
+}
+
+double readValue(const MappedFile& file, uint64_t row, int column) {
+    return *file.at<double>(valueOffset(row, column));
+}
+
+// NaN sorts below every number
+bool greaterMetric(double a, double b) {
+    if (std::isnan(a)) return false;
+    if (std::isnan(b)) return true;
+    return a > b;
+}
+
+bool passes(const MappedFile& file, uint64_t row, const vector<ResultFilter>& filters) {
+    for (const auto& f : filters) {
+        double v = readValue(file, row, f.column);
+        if (!(v >= f.minValue && v <= f.maxValue)) return false;
+    }
+    return true;
+}
+
+StoredResult decode(const MappedFile& file, uint64_t row) {
+    double v[NUM_RESULT_COLUMNS];
+    for (int c = 0; c < NUM_RESULT_COLUMNS; c++) v[c] = readValue(file, row, c);
+    
+    StoredResult r;
+    r.id = row;
+    int flags = static_cast<int>(v[COL_FLAGS]);
+    r.config.shortMA = static_cast<int>(v[COL_SHORT_MA]);
+    r.config.longMA = static_cast<int>(v[COL_LONG_MA]);
+    r.config.initialCapital = v[COL_INITIAL_CAPITAL];
+    r.config.useRSI = (flags & FLAG_RSI) != 0;
+    r.config.useEMA = (flags & FLAG_EMA) != 0;
+    r.config.useMACD = (flags & FLAG_MACD) != 0;
+    r.config.useBollinger = (flags & FLAG_BOLLINGER) != 0;
+    r.config.useKelly = (flags & FLAG_KELLY) != 0;
+    r.config.stopLoss = v[COL_STOP_LOSS];
+    r.config.takeProfit = v[COL_TAKE_PROFIT];
+    r.config.commission = v[COL_COMMISSION];
+    r.config.slippage = v[COL_SLIPPAGE];
+    r.metrics.totalReturn = v[COL_TOTAL_RETURN];
+    r.metrics.cagr = v[COL_CAGR];
+    r.metrics.maxDrawdown = v[COL_MAX_DRAWDOWN];
+    r.metrics.sharpeRatio = v[COL_SHARPE];
+    r.metrics.numTrades = static_cast<int>(v[COL_NUM_TRADES]);
+    r.metrics.winningTrades = static_cast<int>(v[COL_WINNING_TRADES]);
+    r.metrics.winRate = v[COL_WIN_RATE];
+    r.metrics.avgWin = v[COL_AVG_WIN];
+    r.metrics.avgLoss = v[COL_AVG_LOSS];
+    r.metrics.profitFactor = v[COL_PROFIT_FACTOR];
+    return r;
+}
+}
+
+ResultStore::ResultStore(const string& p)
+    : path(p), count(0), dirty(false),
+      block(static_cast<size_t>(BLOCK_ROWS) * NUM_RESULT_COLUMNS, 0.0) {
+    ifstream in(path, ios::binary);
+    if (in.is_open()) {
+        StoreHeader h;
+        if (!in.read(reinterpret_cast<char*>(&h), sizeof(h)) ||
+            memcmp(h.magic, STORE_MAGIC, sizeof(STORE_MAGIC) - 1) != 0) {
+            throw runtime_error("Not a result store: " + path);
+        }
+        if (h.magic[7] != STORE_MAGIC[7]) {
+            throw runtime_error("Result store " + path + " has format version " + string(1, h.magic[7]) +
+                                ", expected " + string(1, STORE_MAGIC[7]));
+        }
+        if (h.numColumns != NUM_RESULT_COLUMNS || h.blockRows != BLOCK_ROWS) {
+            throw runtime_error("Incompatible result store layout: " + path);
+        }
+        count = h.count;
+        
+        // Reload the trailing partial block so appends continue in place
+        if (count % BLOCK_ROWS != 0) {
+            in.seekg(sizeof(StoreHeader) + (count / BLOCK_ROWS) * BLOCK_BYTES);
+            in.read(reinterpret_cast<char*>(block.data()), BLOCK_BYTES);
+        }
+        return;
+    }
+    
+    // Like the other outputs, a missing results/ directory is created
+    ResultExport::ensureParentDirectory(path);
+    ofstream out(path, ios::binary);
+    if (!out.is_open()) {
+        throw runtime_error("Cannot create result store: " + path);
+    }
+    StoreHeader h = {};
+    memcpy(h.magic, STORE_MAGIC, sizeof(STORE_MAGIC));
+    h.numColumns = NUM_RESULT_COLUMNS;
+    h.blockRows = BLOCK_ROWS;
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+}
+
+ResultStore::~ResultStore() {
+    try {
+        flush();
+    } catch (...) {
+        // Destructors must not throw; an explicit flush() reports errors
+    }
+}
+
+void ResultStore::append(const BacktestConfig& config, const PerformanceMetrics& m) {
+    size_t row = count % BLOCK_ROWS;
+    auto set = [&](ResultColumn c, double v) { block[c * BLOCK_ROWS + row] = v; };
+    
+    int flags = (config.useRSI ? FLAG_RSI : 0) | (config.useEMA ? FLAG_EMA : 0) |
+                (config.useMACD ? FLAG_MACD : 0) | (config.useBollinger ? FLAG_BOLLINGER : 0) |
+                (config.useKelly ? FLAG_KELLY : 0);
+    set(COL_SHORT_MA, config.shortMA);
+    set(COL_LONG_MA, config.longMA);
+    set(COL_FLAGS, flags);
+    set(COL_STOP_LOSS, config.stopLoss);
+    set(COL_TAKE_PROFIT, config.takeProfit);
+    set(COL_COMMISSION, config.commission);
+    set(COL_SLIPPAGE, config.slippage);
+    set(COL_INITIAL_CAPITAL, config.initialCapital);
+    set(COL_TOTAL_RETURN, m.totalReturn);
+    set(COL_CAGR, m.cagr);
+    set(COL_MAX_DRAWDOWN, m.maxDrawdown);
+    set(COL_SHARPE, m.sharpeRatio);
+    set(COL_NUM_TRADES, m.numTrades);
+    set(COL_WINNING_TRADES, m.winningTrades);
+    set(COL_WIN_RATE, m.winRate);
+    set(COL_AVG_WIN, m.avgWin);
+    set(COL_AVG_LOSS, m.avgLoss);
+    set(COL_PROFIT_FACTOR, m.profitFactor);
+    
+    count++;
+    dirty = true;
+    
+    if (count % BLOCK_ROWS == 0) {
+        writeBlock((count - 1) / BLOCK_ROWS);
+        fill(block.begin(), block.end(), 0.0);
+    }
+}
+
+void ResultStore::flush() {
+    if (!dirty) return;
+    writeBlock(count / BLOCK_ROWS);
+}
+
+void ResultStore::writeBlock(uint64_t blockIndex) {
+    fstream f(path, ios::in | ios::out | ios::binary);
+    if (!f.is_open()) {
+        throw runtime_error("Cannot write result store: " + path);
+    }
+    
+    // A full block just written is followed by an empty slot; nothing to pad
+    if (blockIndex * BLOCK_ROWS < count) {
+        f.seekp(sizeof(StoreHeader) + blockIndex * BLOCK_BYTES);
+        f.write(reinterpret_cast<const char*>(block.data()), BLOCK_BYTES);
+    }
+    
+    StoreHeader h = {};
+    memcpy(h.magic, STORE_MAGIC, sizeof(STORE_MAGIC));
+    h.numColumns = NUM_RESULT_COLUMNS;
+    h.blockRows = BLOCK_ROWS;
+    h.count = count;
+    f.seekp(0);
+    f.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    
+    if (!f) {
+        throw runtime_error("Failed writing result store: " + path);
+    }
+    dirty = false;
+}
+
+string ResultStore::indexPath(ResultColumn column) const {
+    return path + "." + columnName(column) + ".idx";
+}
+
+void ResultStore::buildIndex(ResultColumn column) {
+    flush();
+    MappedFile file(path);
+    
+    vector<double> values(count);
+    for (uint64_t r = 0; r < count; r++) values[r] = readValue(file, r, column);
+    
+    vector<uint32_t> ids(count);
+    for (uint64_t r = 0; r < count; r++) ids[r] = static_cast<uint32_t>(r);
+    stable_sort(ids.begin(), ids.end(), [&](uint32_t a, uint32_t b) {
+        return greaterMetric(values[a], values[b]);
+    });
+    
+    // Written aside and renamed, so a short write never leaves an index whose
+    // header promises more ids than the file holds
+    string target = indexPath(column);
+    string temp = target + ".tmp";
+    {
+        ofstream out(temp, ios::binary);
+        IndexHeader h = {};
+        memcpy(h.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        h.column = column;
+        h.count = count;
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char*>(ids.data()), ids.size() * sizeof(uint32_t));
+        out.close();
+        if (!out) {
+            remove(temp.c_str());
+            throw runtime_error("Cannot write index: " + target);
+        }
+    }
+    if (rename(temp.c_str(), target.c_str()) != 0) {
+        remove(temp.c_str());
+        throw runtime_error("Cannot write index: " + target);
+    }
+}
+
+bool ResultStore::hasFreshIndex(ResultColumn column) const {
+    ifstream in(indexPath(column), ios::binary);
+    IndexHeader h;
+    if (!in.is_open() || !in.read(reinterpret_cast<char*>(&h), sizeof(h))) return false;
+    return memcmp(h.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+           h.column == static_cast<uint32_t>(column) && h.count == count;
+}
+
+vector<StoredResult> ResultStore::topK(ResultColumn by, size_t k, const vector<ResultFilter>& filters) {
+    flush();
+    vector<StoredResult> result;
+    if (count == 0 || k == 0) return result;
+    
+    MappedFile file(path);
+    
+    if (hasFreshIndex(by)) {
+        // Index order is already best-first: stop after k matches. A
+        // truncated file or an out-of-range id falls back to the scan below.
+        MappedFile index(indexPath(by));
+        bool valid = index.size() >= sizeof(IndexHeader) + count * sizeof(uint32_t);
+        const uint32_t* ids = valid ? index.at<uint32_t>(sizeof(IndexHeader)) : nullptr;
+        for (uint64_t i = 0; valid && i < count && result.size() < k; i++) {
+            if (ids[i] >= count) {
+                valid = false;
+            } else if (passes(file, ids[i], filters)) {
+                result.push_back(decode(file, ids[i]));
+            }
+        }
+        if (valid) return result;
+        result.clear();
+    }
+    
+    // No index: single pass with a size-k min-heap over the mapped column.
+    // Ties go to the lower id, matching the stable index order.
+    typedef pair<double, uint64_t> Entry;
+    auto better = [](const Entry& a, const Entry& b) {
+        if (greaterMetric(a.first, b.first)) return true;
+        if (greaterMetric(b.first, a.first)) return false;
+        return a.second < b.second;
+    };
+    priority_queue<Entry, vector<Entry>, decltype(better)> heap(better);
+    for (uint64_t r = 0; r < count; r++) {
+        if (!passes(file, r, filters)) continue;
+        Entry e(readValue(file, r, by), r);
+        if (heap.size() < k) {
+            heap.push(e);
+        } else if (better(e, heap.top())) {
+            heap.pop();
+            heap.push(e);
+        }
+    }
+    
+    while (!heap.empty()) {
+        result.push_back(decode(file, heap.top().second));
+        heap.pop();
+    }
+    reverse(result.begin(), result.end());
+    return result;
+}
+
+const char* ResultStore::columnName(ResultColumn column) {
+    switch (column) {
+        case COL_SHORT_MA: return "short_ma";
+        case COL_LONG_MA: return "long_ma";
+        case COL_FLAGS: return "flags";
+        case COL_STOP_LOSS: return "stop_loss";
+        case COL_TAKE_PROFIT: return "take_profit";
+        case COL_COMMISSION: return "commission";
+        case COL_SLIPPAGE: return "slippage";
+        case COL_INITIAL_CAPITAL: return "initial_capital";
+        case COL_TOTAL_RETURN: return "total_return";
+        case COL_CAGR: return "cagr";
+        case COL_MAX_DRAWDOWN: return "max_drawdown";
+        case COL_SHARPE: return "sharpe";
+        case COL_NUM_TRADES: return "num_trades";
+        case COL_WINNING_TRADES: return "winning_trades";
+        case COL_WIN_RATE: return "win_rate";
+        case COL_AVG_WIN: return "avg_win";
+        case COL_AVG_LOSS: return "avg_loss";
+        case COL_PROFIT_FACTOR: return "profit_factor";
+        default: return "unknown";
+    }
+}
+
+bool ResultStore::columnFromName(const string& name, ResultColumn& column) {
+    for (int c = 0; c < NUM_RESULT_COLUMNS; c++) {
+        if (name == columnName(static_cast<ResultColumn>(c))) {
+            column = static_cast<ResultColumn>(c);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,120 @@
+#include "../include/RuntimeMetrics.hpp"
+#include "../include/AllocTracker.hpp"
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+using namespace std;
+
+namespace {
+struct alignas(64) Shard {
+    atomic<uint64_t> value[NUM_RUNTIME_METRICS];
+    
+    Shard() {
+        for (auto& v : value) v.store(0, memory_order_relaxed);
+    }
+};
+
+// Shards are kept after their thread exits so totals never go backwards
+mutex registryMutex;
+vector<unique_ptr<Shard>> registry;
+thread_local Shard* current = nullptr;
+
+const chrono::steady_clock::time_point processStart = chrono::steady_clock::now();
+
+Shard* threadShard() {
+    if (current) return current;
+    lock_guard<mutex> lock(registryMutex);
+    registry.emplace_back(new Shard());
+    current = registry.back().get();
+    return current;
+}
+
+void describe(ostringstream& out, const char* name, const char* type, const char* help) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+}
+
+void counter(ostringstream& out, const char* name, const char* help, uint64_t value) {
+    describe(out, name, "counter", help);
+    out << name << " " << value << "\n";
+}
+
+void gauge(ostringstream& out, const char* name, const char* help, double value) {
+    describe(out, name, "gauge", help);
+    out << name << " ";
+    if (std::isnan(value)) {
+        out << "NaN";
+    } else {
+        out << value;
+    }
+    out << "\n";
+}
+
+double difference(RuntimeMetric queued, RuntimeMetric done) {
+    // Read done first so a concurrent increment can only overstate the depth
+    uint64_t d = RuntimeMetrics::total(done);
+    uint64_t q = RuntimeMetrics::total(queued);
+    return q > d ? static_cast<double>(q - d) : 0.0;
+}
+}
+
+void RuntimeMetrics::add(RuntimeMetric metric, uint64_t n) {
+    atomic<uint64_t>& v = threadShard()->value[metric];
+    v.store(v.load(memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+uint64_t RuntimeMetrics::total(RuntimeMetric metric) {
+    lock_guard<mutex> lock(registryMutex);
+    uint64_t sum = 0;
+    for (const auto& s : registry) sum += s->value[metric].load(memory_order_relaxed);
+    return sum;
+}
+
+string RuntimeMetrics::exposition() {
+    uint64_t hits = total(METRIC_CACHE_HITS);
+    uint64_t misses = total(METRIC_CACHE_MISSES);
+    
+    ostringstream out;
+    out.precision(12);
+    counter(out, "backtester_bars_processed_total", "Bars simulated by completed backtests.", total(METRIC_BARS));
+    counter(out, "backtester_backtests_total", "Completed backtests.", total(METRIC_BACKTESTS));
+    counter(out, "backtester_reprices_total", "Cost-sweep reprices of recorded fills.", total(METRIC_REPRICES));
+    counter(out, "backtester_cache_hits_total", "Result cache hits in this process.", hits);
+    counter(out, "backtester_cache_misses_total", "Result cache misses in this process.", misses);
+    gauge(out, "backtester_cache_hit_ratio", "Result cache hits over lookups (NaN before the first lookup).",
+          hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : NAN);
+    counter(out, "backtester_universe_symbols_done_total", "Universe symbols finished by the workers.",
+            total(METRIC_SYMBOLS_DONE));
+    gauge(out, "backtester_universe_symbols_pending", "Universe symbols queued or in progress.",
+          difference(METRIC_SYMBOLS_QUEUED, METRIC_SYMBOLS_DONE));
+    counter(out, "backtester_exports_total", "Result files handled by the background writer.",
+            total(METRIC_EXPORTS_DONE));
+    gauge(out, "backtester_export_queue_depth", "Result files waiting for or being written by the background writer.",
+          difference(METRIC_EXPORTS_QUEUED, METRIC_EXPORTS_DONE));
+    gauge(out, "process_resident_memory_bytes", "Resident memory size in bytes.",
+          static_cast<double>(residentBytes()));
+    gauge(out, "backtester_peak_resident_memory_bytes", "Resident memory high-water mark in bytes.",
+          static_cast<double>(AllocTracker::peakRssBytes()));
+    gauge(out, "backtester_uptime_seconds", "Seconds since the process started.",
+          chrono::duration<double>(chrono::steady_clock::now() - processStart).count());
+    return out.str();
+}
+
+uint64_t RuntimeMetrics::residentBytes() {
+#ifndef _WIN32
+    ifstream statm("/proc/self/statm");
+    uint64_t size = 0, resident = 0;
+    if (statm >> size >> resident) {
+        return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return 0;
+}
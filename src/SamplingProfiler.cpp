@@ -0,0 +1,307 @@
+#include "../include/SamplingProfiler.hpp"
+#include "../include/MappedFile.hpp"
+#include "../include/ReportWriter.hpp"
+#include <atomic>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#if defined(__linux__) && defined(__GLIBC__)
+#define SAMPLING_SUPPORTED 1
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <dlfcn.h>
+#include <elf.h>
+#include <cxxabi.h>
+#else
+#define SAMPLING_SUPPORTED 0
+#endif
+using namespace std;
+
+namespace {
+// One distinct stack. The first sampler to see it claims the slot by setting
+// `hash`, fills the frames and then publishes `ready`; later samples of the
+// same stack only bump `count`. A sampler that finds a matching slot not yet
+// ready keeps probing, which at worst splits one stack over two slots.
+struct StackSlot {
+    atomic<uint64_t> hash{0};   // 0 = free
+    atomic<bool> ready{false};
+    atomic<uint64_t> count{0};
+    uint32_t depth = 0;
+    void* frames[SamplingProfiler::MAX_DEPTH];
+};
+
+const size_t MAX_PROBES = 64;
+const int SKIP_FRAMES = 2;   // The handler and the kernel's signal trampoline
+
+// Allocated by the first start() and never freed: a late SIGPROF may still be in flight
+StackSlot* table = nullptr;
+atomic<bool> sampling{false};
+atomic<uint64_t> samples{0};
+atomic<uint64_t> dropped{0};
+string reason;
+
+#if SAMPLING_SUPPORTED
+uint64_t hashFrames(void* const* frames, int n) {
+    uint64_t h = 1469598103934665603ull;
+    for (int i = 0; i < n; i++) {
+        h = (h ^ reinterpret_cast<uintptr_t>(frames[i])) * 1099511628211ull;
+    }
+    return h | 1;
+}
+
+// Runs in signal context: only atomics, memcpy and the pre-warmed backtrace()
+void onSample(int) {
+    if (!sampling.load(memory_order_relaxed)) return;
+    int savedErrno = errno;
+    void* frames[SamplingProfiler::MAX_DEPTH + SKIP_FRAMES];
+    int n = backtrace(frames, SamplingProfiler::MAX_DEPTH + SKIP_FRAMES);
+    int depth = n - SKIP_FRAMES;
+    if (depth <= 0) {
+        dropped.fetch_add(1, memory_order_relaxed);
+        errno = savedErrno;
+        return;
+    }
+    void** stack = frames + SKIP_FRAMES;
+    uint64_t h = hashFrames(stack, depth);
+    size_t mask = SamplingProfiler::MAX_STACKS - 1;
+    
+    for (size_t p = 0; p < MAX_PROBES; p++) {
+        StackSlot& s = table[(h + p) & mask];
+        uint64_t cur = s.hash.load(memory_order_acquire);
+        if (cur == 0 && s.hash.compare_exchange_strong(cur, h, memory_order_acq_rel)) {
+            s.depth = static_cast<uint32_t>(depth);
+            memcpy(s.frames, stack, depth * sizeof(void*));
+            s.count.store(1, memory_order_relaxed);
+            s.ready.store(true, memory_order_release);
+            samples.fetch_add(1, memory_order_relaxed);
+            errno = savedErrno;
+            return;
+        }
+        if (cur == h && s.ready.load(memory_order_acquire) &&
+            s.depth == static_cast<uint32_t>(depth) &&
+            memcmp(s.frames, stack, depth * sizeof(void*)) == 0) {
+            s.count.fetch_add(1, memory_order_relaxed);
+            samples.fetch_add(1, memory_order_relaxed);
+            errno = savedErrno;
+            return;
+        }
+    }
+    dropped.fetch_add(1, memory_order_relaxed);
+    errno = savedErrno;
+}
+
+// Function symbols from the executable's own .symtab. dladdr only sees the
+// dynamic symbol table, which lacks static and anonymous-namespace functions
+// unless the binary is linked with -rdynamic.
+class ExecutableSymbols {
+public:
+    ExecutableSymbols() : relocatable(false) {
+        try {
+            MappedFile exe("/proc/self/exe");
+            load(exe);
+        } catch (const exception&) {
+            // Unreadable or stripped: callers fall back to module+offset
+        }
+    }
+    
+    const string* find(uintptr_t address, uintptr_t moduleBase) const {
+        uint64_t a = relocatable ? address - moduleBase : address;
+        auto it = upper_bound(symbols.begin(), symbols.end(), a,
+                              [](uint64_t v, const Symbol& s) { return v < s.start; });
+        if (it == symbols.begin()) return nullptr;
+        --it;
+        return a < it->end ? &it->name : nullptr;
+    }
+
+private:
+    struct Symbol {
+        uint64_t start;
+        uint64_t end;
+        string name;
+    };
+    vector<Symbol> symbols;
+    bool relocatable;   // PIE: symbol values are offsets from the load base
+    
+    void load(const MappedFile& exe) {
+        if (exe.size() < sizeof(Elf64_Ehdr)) return;
+        const Elf64_Ehdr* eh = exe.at<Elf64_Ehdr>(0);
+        if (memcmp(eh->e_ident, ELFMAG, SELFMAG) != 0 || eh->e_ident[EI_CLASS] != ELFCLASS64) return;
+        if (eh->e_shoff + static_cast<uint64_t>(eh->e_shnum) * sizeof(Elf64_Shdr) > exe.size()) return;
+        relocatable = eh->e_type == ET_DYN;
+        const Elf64_Shdr* sections = exe.at<Elf64_Shdr>(eh->e_shoff);
+        for (size_t i = 0; i < eh->e_shnum; i++) {
+            const Elf64_Shdr& sh = sections[i];
+            if (sh.sh_type != SHT_SYMTAB || sh.sh_link >= eh->e_shnum) continue;
+            const Elf64_Shdr& strtab = sections[sh.sh_link];
+            if (sh.sh_offset + sh.sh_size > exe.size() || strtab.sh_offset + strtab.sh_size > exe.size()) return;
+            const Elf64_Sym* syms = exe.at<Elf64_Sym>(sh.sh_offset);
+            const char* names = exe.data() + strtab.sh_offset;
+            for (size_t k = 0; k < sh.sh_size / sizeof(Elf64_Sym); k++) {
+                const Elf64_Sym& s = syms[k];
+                if (ELF64_ST_TYPE(s.st_info) != STT_FUNC || s.st_value == 0 || s.st_size == 0) continue;
+                if (s.st_name >= strtab.sh_size) continue;
+                symbols.push_back({s.st_value, s.st_value + s.st_size, names + s.st_name});
+            }
+        }
+        sort(symbols.begin(), symbols.end(),
+             [](const Symbol& a, const Symbol& b) { return a.start < b.start; });
+    }
+};
+
+string demangle(const char* name) {
+    int status = 0;
+    char* readable = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    string out = status == 0 && readable ? readable : name;
+    free(readable);
+    // ';' separates frames in the collapsed format
+    replace(out.begin(), out.end(), ';', ':');
+    return out;
+}
+
+// Name of the function containing `address`; callers' frames hold return
+// addresses, so step back into the call instruction before looking them up
+string frameName(void* frame, bool returnAddress, const ExecutableSymbols& exeSymbols, uintptr_t exeBase) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(frame) - (returnAddress ? 1 : 0);
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void*>(address), &info) == 0) return "[unknown]";
+    uintptr_t base = reinterpret_cast<uintptr_t>(info.dli_fbase);
+    if (base == exeBase) {
+        if (const string* name = exeSymbols.find(address, base)) return demangle(name->c_str());
+    }
+    if (info.dli_sname) return demangle(info.dli_sname);
+    
+    string module = info.dli_fname ? info.dli_fname : "";
+    module = module.substr(module.find_last_of('/') + 1);
+    char offset[32];
+    snprintf(offset, sizeof(offset), "+0x%llx", static_cast<unsigned long long>(address - base));
+    return (module.empty() ? "[unknown]" : module) + offset;
+}
+#endif
+}
+
+bool SamplingProfiler::start(int hz) {
+#if SAMPLING_SUPPORTED
+    if (running()) return true;
+    if (hz < 1 || hz > 10000) {
+        reason = "sampling rate must be between 1 and 10000 Hz";
+        return false;
+    }
+    if (!table) table = new StackSlot[MAX_STACKS];
+    
+    // The first backtrace() loads the unwinder, which allocates; do it here
+    // rather than inside the signal handler
+    void* warmup[4];
+    backtrace(warmup, 4);
+    
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onSample;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) != 0) {
+        reason = string("sigaction: ") + strerror(errno);
+        return false;
+    }
+    
+    sampling.store(true, memory_order_release);
+    itimerval timer;
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = 1000000 / hz;
+    if (hz == 1) {
+        timer.it_interval.tv_sec = 1;
+        timer.it_interval.tv_usec = 0;
+    }
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+        sampling.store(false, memory_order_release);
+        reason = string("setitimer: ") + strerror(errno);
+        return false;
+    }
+    return true;
+#else
+    (void)hz;
+    reason = "sampling needs Linux with glibc (SIGPROF timers and backtrace)";
+    return false;
+#endif
+}
+
+void SamplingProfiler::stop() {
+#if SAMPLING_SUPPORTED
+    if (!running()) return;
+    itimerval off;
+    memset(&off, 0, sizeof(off));
+    setitimer(ITIMER_PROF, &off, nullptr);
+    // The handler stays installed and ignores a SIGPROF still pending; the
+    // default action would terminate the process
+    sampling.store(false, memory_order_release);
+#endif
+}
+
+bool SamplingProfiler::running() {
+    return sampling.load(memory_order_acquire);
+}
+
+string SamplingProfiler::unavailableReason() {
+    return reason;
+}
+
+bool SamplingProfiler::writeCollapsed(const string& filename) {
+    // Merge on the symbolized text: different return addresses inside one
+    // function, and stacks split over two slots, become one line
+    map<string, uint64_t> stacks;
+#if SAMPLING_SUPPORTED
+    if (table) {
+        ExecutableSymbols exeSymbols;
+        Dl_info self;
+        uintptr_t exeBase = dladdr(reinterpret_cast<void*>(&onSample), &self) != 0
+            ? reinterpret_cast<uintptr_t>(self.dli_fbase) : 0;
+        unordered_map<void*, string> names[2];
+        
+        for (size_t i = 0; i < MAX_STACKS; i++) {
+            const StackSlot& s = table[i];
+            if (!s.ready.load(memory_order_acquire)) continue;
+            string line;
+            for (size_t k = s.depth; k-- > 0;) {
+                bool returnAddress = k > 0;
+                auto it = names[returnAddress].find(s.frames[k]);
+                if (it == names[returnAddress].end()) {
+                    it = names[returnAddress].emplace(
+                        s.frames[k], frameName(s.frames[k], returnAddress, exeSymbols, exeBase)).first;
+                }
+                if (!line.empty()) line += ';';
+                line += it->second;
+            }
+            stacks[line] += s.count.load(memory_order_relaxed);
+        }
+    }
+#endif
+
+    ReportWriter out(filename);
+    if (!out.isOpen()) return false;
+    for (const auto& s : stacks) {
+        out.text(s.first).put(' ').integer(static_cast<long long>(s.second)).put('\n');
+    }
+    return out.close();
+}
+
+uint64_t SamplingProfiler::sampleCount() {
+    return samples.load(memory_order_relaxed);
+}
+
+uint64_t SamplingProfiler::droppedSamples() {
+    return dropped.load(memory_order_relaxed);
+}
+
+size_t SamplingProfiler::stackCount() {
+    size_t n = 0;
+    for (size_t i = 0; table && i < MAX_STACKS; i++) {
+        if (table[i].ready.load(memory_order_relaxed)) n++;
+    }
+    return n;
+}
@@ -0,0 +1,110 @@
+#include "../include/SeriesRecorder.hpp"
+#include "../include/ReportWriter.hpp"
+#include "../include/MappedFile.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <new>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+using namespace std;
+
+namespace {
+const size_t HUGE_PAGE = 2 << 20;
+
+// Large blocks are 2 MB aligned and marked for transparent huge pages, which
+// cuts first-touch page faults ~500x compared with 4 KB pages
+shared_ptr<double> allocateBlock(size_t count) {
+    size_t bytes = count * sizeof(double);
+    if (bytes == 0) return shared_ptr<double>();
+    
+#ifdef __linux__
+    if (bytes >= HUGE_PAGE) {
+        size_t rounded = (bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+        void* p = aligned_alloc(HUGE_PAGE, rounded);
+        if (!p) throw bad_alloc();
+        madvise(p, rounded, MADV_HUGEPAGE);
+        return shared_ptr<double>(static_cast<double*>(p), free);
+    }
+#endif
+    return shared_ptr<double>(new double[count], default_delete<double[]>());
+}
+}
+
+void SeriesRecorder::allocate(size_t numBars, const vector<string>& columnNames) {
+    bars = numBars;
+    recorded = columnNames.size();
+    names = columnNames;
+    adopted.clear();
+    mapped.reset();
+    nextRelease = SIZE_MAX;
+    block = allocateBlock(bars * recorded);
+}
+
+void SeriesRecorder::allocateMapped(const string& path, size_t numBars,
+                                    const vector<string>& columnNames) {
+    bars = numBars;
+    recorded = columnNames.size();
+    names = columnNames;
+    adopted.clear();
+    
+    // Columns start on a page boundary after the header and names
+    size_t headerBytes = sizeof(SeriesFileHeader) + recorded * SERIES_NAME_CHARS;
+    dataOffset = (headerBytes + 4095) / 4096 * 4096;
+    mapped = make_shared<MappedOutputFile>(path, dataOffset + bars * recorded * sizeof(double));
+    
+    SeriesFileHeader* header = mapped->at<SeriesFileHeader>(0);
+    memcpy(header->magic, SERIES_FILE_MAGIC, sizeof(header->magic));
+    header->version = SERIES_FILE_VERSION;
+    header->numColumns = static_cast<uint32_t>(recorded);
+    header->numBars = bars;
+    header->dataOffset = dataOffset;
+    for (size_t c = 0; c < recorded; c++) {
+        char* name = mapped->data() + sizeof(SeriesFileHeader) + c * SERIES_NAME_CHARS;
+        memcpy(name, names[c].data(), min(names[c].size(), SERIES_NAME_CHARS - 1));
+    }
+    
+    // The block aliases the mapping and keeps it alive (copies share it)
+    block = shared_ptr<double>(mapped, mapped->at<double>(dataOffset));
+    releasedBars = 0;
+    nextRelease = RELEASE_BARS;
+}
+
+void SeriesRecorder::releaseBefore(size_t bar) {
+    for (size_t c = 0; c < recorded; c++) {
+        size_t offset = dataOffset + (c * bars + releasedBars) * sizeof(double);
+        mapped->release(offset, (bar - releasedBars) * sizeof(double));
+    }
+    releasedBars = bar;
+    nextRelease = bar + RELEASE_BARS;
+}
+
+void SeriesRecorder::adopt(const string& columnName, vector<double>&& values) {
+    values.resize(bars, 0.0);
+    names.push_back(columnName);
+    adopted.push_back(move(values));
+}
+
+bool SeriesRecorder::writeCSV(const string& filename,
+                              const vector<OHLCV>& dates,
+                              int precision) const {
+    ReportWriter out(filename);
+    if (!out.isOpen()) return false;
+    
+    out.text("Date");
+    for (const auto& n : names) out.put(',').text(n);
+    out.put('\n');
+    
+    vector<const double*> cols(names.size());
+    for (size_t c = 0; c < cols.size(); c++) cols[c] = column(c);
+    
+    for (size_t i = 0; i < bars; i++) {
+        if (i < dates.size()) out.text(dates[i].date);
+        for (size_t c = 0; c < cols.size(); c++) {
+            out.put(',').fixed(cols[c][i], precision);
+        }
+        out.put('\n');
+    }
+    return out.close();
+}
@@ -0,0 +1,149 @@
+#include "../include/Tracer.hpp"
+#include "../include/ReportWriter.hpp"
+#include "../include/JsonWriter.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+using namespace std;
+
+namespace {
+// Ring owned by one producer thread; `written` only grows and is published
+// with release so the dump sees complete events
+struct ThreadTrace {
+    uint32_t tid;
+    string name;
+    vector<TraceEvent> events;
+    size_t mask;
+    atomic<uint64_t> written{0};
+};
+
+atomic<bool> tracingEnabled{false};
+size_t ringCapacity = Tracer::DEFAULT_EVENTS_PER_THREAD;
+chrono::steady_clock::time_point epoch;
+
+// Rings outlive their threads so workers can exit before the dump
+mutex registryMutex;
+vector<unique_ptr<ThreadTrace>> registry;
+thread_local ThreadTrace* current = nullptr;
+
+ThreadTrace* threadTrace() {
+    if (current) return current;
+    lock_guard<mutex> lock(registryMutex);
+    unique_ptr<ThreadTrace> t(new ThreadTrace());
+    t->tid = static_cast<uint32_t>(registry.size() + 1);
+    t->name = t->tid == 1 ? "main" : "thread " + to_string(t->tid);
+    t->events.resize(ringCapacity);
+    t->mask = ringCapacity - 1;
+    current = t.get();
+    registry.push_back(move(t));
+    return current;
+}
+
+void push(char phase, const char* name, const char* detail) {
+    ThreadTrace* t = threadTrace();
+    uint64_t i = t->written.load(memory_order_relaxed);
+    TraceEvent& e = t->events[i & t->mask];
+    e.ts = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - epoch).count());
+    e.name = name;
+    e.phase = phase;
+    if (detail) {
+        // Keep the tail: for paths the file name matters more than the directory
+        size_t n = strlen(detail);
+        size_t keep = min(n, sizeof(e.detail) - 1);
+        memcpy(e.detail, detail + n - keep, keep);
+        e.detail[keep] = '\0';
+    } else {
+        e.detail[0] = '\0';
+    }
+    t->written.store(i + 1, memory_order_release);
+}
+}
+
+void Tracer::enable(size_t eventsPerThread) {
+    size_t capacity = 1;
+    while (capacity < eventsPerThread) capacity <<= 1;
+    ringCapacity = capacity;
+    epoch = chrono::steady_clock::now();
+    tracingEnabled.store(true, memory_order_release);
+}
+
+bool Tracer::enabled() {
+    return tracingEnabled.load(memory_order_relaxed);
+}
+
+void Tracer::begin(const char* name, const char* detail) {
+    if (enabled()) push('B', name, detail);
+}
+
+void Tracer::end(const char* name) {
+    if (enabled()) push('E', name, nullptr);
+}
+
+void Tracer::setThreadName(const string& name) {
+    if (!enabled()) return;
+    ThreadTrace* t = threadTrace();
+    lock_guard<mutex> lock(registryMutex);
+    t->name = name;
+}
+
+uint64_t Tracer::eventCount() {
+    lock_guard<mutex> lock(registryMutex);
+    uint64_t n = 0;
+    for (const auto& t : registry) {
+        n += min<uint64_t>(t->written.load(memory_order_acquire), t->events.size());
+    }
+    return n;
+}
+
+uint64_t Tracer::droppedEvents() {
+    lock_guard<mutex> lock(registryMutex);
+    uint64_t n = 0;
+    for (const auto& t : registry) {
+        uint64_t w = t->written.load(memory_order_acquire);
+        if (w > t->events.size()) n += w - t->events.size();
+    }
+    return n;
+}
+
+bool Tracer::writeChromeTrace(const string& filename) {
+    ReportWriter out(filename);
+    if (!out.isOpen()) return false;
+    JsonWriter json(out);
+    
+    lock_guard<mutex> lock(registryMutex);
+    json.beginObject().key("displayTimeUnit").value("ms");
+    json.key("traceEvents").beginArray();
+    for (const auto& t : registry) {
+        json.beginObject()
+            .key("name").value("thread_name").key("ph").value("M")
+            .key("pid").value(1).key("tid").value(static_cast<long long>(t->tid))
+            .key("args").beginObject().key("name").value(t->name).endObject()
+            .endObject();
+    
+        // Oldest surviving event first; an overwritten ring may start with
+        // unmatched ends, which viewers ignore
+        uint64_t written = t->written.load(memory_order_acquire);
+        uint64_t first = written > t->events.size() ? written - t->events.size() : 0;
+        for (uint64_t i = first; i < written; i++) {
+            const TraceEvent& e = t->events[i & t->mask];
+            char phase[2] = {e.phase, '\0'};
+            json.beginObject()
+                .key("name").value(e.name)
+                .key("ph").value(phase)
+                .key("ts").value(e.ts / 1000.0)
+                .key("pid").value(1)
+                .key("tid").value(static_cast<long long>(t->tid));
+            if (e.detail[0]) {
+                json.key("args").beginObject().key("detail").value(e.detail).endObject();
+            }
+            json.endObject();
+        }
+    }
+    json.endArray().endObject().endRecord();
+    return out.close();
+}
@@ -0,0 +1,554 @@
+#include "../include/TradeArchive.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+using namespace std;
+
+namespace {
+enum ArchiveColumn {
+    COL_ENTRY_BAR_DELTA,
+    COL_HOLD_BARS,
+    COL_ENTRY_DAY_RESIDUAL,
+    COL_HOLD_DAY_RESIDUAL,
+    COL_ENTRY_PRICE_DELTA,
+    COL_EXIT_PRICE_DELTA,
+    COL_SHARES_RESIDUAL,
+    COL_COST_RESIDUAL,
+    COL_RETURN_RESIDUAL,
+    COL_FLAGS,
+    NUM_ARCHIVE_COLUMNS
+};
+
+const size_t FRAME = 128;
+
+// Special-value codes (3 bits per field in the flags column)
+enum SpecialValue {
+    VALUE_NORMAL = 0,
+    VALUE_NEGATIVE_ZERO = 1,   // Prints as "-0.00"
+    VALUE_NAN = 2,
+    VALUE_NEGATIVE_NAN = 3,
+    VALUE_INF = 4,
+    VALUE_NEGATIVE_INF = 5
+};
+const int SHARES_FLAG_SHIFT = 2;
+const int PNL_FLAG_SHIFT = 5;
+const int RETURN_FLAG_SHIFT = 8;
+// Prices got their codes later; archives written before have zeros here
+const int ENTRY_PRICE_FLAG_SHIFT = 11;
+const int EXIT_PRICE_FLAG_SHIFT = 14;
+
+void putVarint(vector<uint8_t>& b, uint64_t v) {
+    while (v >= 0x80) {
+        b.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    b.push_back(static_cast<uint8_t>(v));
+}
+
+uint64_t getVarint(const uint8_t*& p, const uint8_t* end) {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p >= end) break;
+        uint8_t byte = *p++;
+        v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return v;
+    }
+    throw runtime_error("Corrupt trade archive (varint)");
+}
+
+uint64_t zigzag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+int64_t unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+// Fixed-point units exactly as to_chars(fixed, decimals) prints the value,
+// so the decoded number formats back to the same CSV text
+int64_t toUnits(double v, int decimals, int& special) {
+    if (std::isnan(v)) {
+        special = signbit(v) ? VALUE_NEGATIVE_NAN : VALUE_NAN;
+        return 0;
+    }
+    if (std::isinf(v)) {
+        special = v < 0 ? VALUE_NEGATIVE_INF : VALUE_INF;
+        return 0;
+    }
+    char buf[400];
+    auto res = to_chars(buf, buf + sizeof(buf), v, chars_format::fixed, decimals);
+    int64_t units = 0;
+    bool negative = false;
+    for (const char* p = buf; p < res.ptr; p++) {
+        if (*p == '-') negative = true;
+        else if (*p != '.') units = units * 10 + (*p - '0');
+    }
+    special = negative && units == 0 ? VALUE_NEGATIVE_ZERO : VALUE_NORMAL;
+    return negative ? -units : units;
+}
+
+double fromUnits(int64_t units, double scale, int special) {
+    switch (special) {
+        case VALUE_NEGATIVE_ZERO: return -0.0;
+        case VALUE_NAN: return NAN;
+        case VALUE_NEGATIVE_NAN: return -NAN;
+        case VALUE_INF: return INFINITY;
+        case VALUE_NEGATIVE_INF: return -INFINITY;
+        default: return units / scale;
+    }
+}
+
+// Round half away from zero; inline, unlike llround
+int64_t roundOrZero(double v) {
+    if (!(fabs(v) < 9e18)) return 0;
+    return v >= 0 ? static_cast<int64_t>(v + 0.5) : -static_cast<int64_t>(0.5 - v);
+}
+
+// Calendar days spanned by a number of daily bars (5 trading days a week)
+int64_t impliedDays(int64_t bars) {
+    return (bars * 7 + 2) / 5;
+}
+
+// P&L implied by prices and shares alone; the difference to the real P&L is costs
+int64_t impliedPnl(int64_t entryCents, int64_t exitCents, int64_t shares) {
+    int64_t num = (exitCents - entryCents) * shares;
+    return (num >= 0 ? num + 5000 : num - 5000) / 10000;
+}
+
+int64_t impliedReturn(int64_t entryCents, int64_t shares, int64_t pnlCents) {
+    double basis = static_cast<double>(entryCents) * static_cast<double>(shares);
+    return basis != 0.0 ? roundOrZero(static_cast<double>(pnlCents) * 1e8 / basis) : 0;
+}
+
+// Predicts a trade's size and costs from the previous one, the way the engine
+// sizes positions: cash after the last exit times a stable fraction, and a
+// constant commission rate. Encoder and decoder feed it the same decoded
+// integers, so predictions match exactly; a poor guess only costs bits.
+struct TradePredictor {
+    bool started = false;
+    bool haveRatio = false;
+    double cash = 0.0;          // Cents after the previous exit
+    double sizeRatio = 0.0;     // Entry notional / cash available
+    double costRate = 0.0;      // Costs / exit notional
+    
+    int64_t shares(int64_t entryCents) const {
+        if (!started || entryCents == 0) return 0;
+        double ratio = haveRatio ? sizeRatio : 1.0 - costRate;
+        return roundOrZero(cash * ratio / entryCents * 10000.0);
+    }
+    
+    int64_t costs(int64_t exitCents, int64_t shares) const {
+        return roundOrZero(costRate * static_cast<double>(exitCents) * shares / 10000.0);
+    }
+    
+    void update(int64_t entryCents, int64_t exitCents, int64_t shares, int64_t pnlCents, int64_t costs) {
+        double entryNotional = static_cast<double>(entryCents) * shares / 10000.0;
+        double exitNotional = static_cast<double>(exitCents) * shares / 10000.0;
+        if (started && cash > 0) {
+            sizeRatio = entryNotional / cash;
+            haveRatio = true;
+        }
+        costRate = exitNotional != 0.0 ? costs / exitNotional : 0.0;
+        cash = entryNotional + pnlCents;
+        started = true;
+    }
+};
+
+// Days since 1970-01-01 (proleptic Gregorian)
+int32_t dayNumber(const string& date) {
+    if (date.size() != 10 || date[4] != '-' || date[7] != '-') {
+        throw runtime_error("Trade archive needs YYYY-MM-DD dates: " + date);
+    }
+    auto digits = [&](size_t pos, size_t n) {
+        int v = 0;
+        for (size_t i = pos; i < pos + n; i++) {
+            if (date[i] < '0' || date[i] > '9') {
+                throw runtime_error("Trade archive needs YYYY-MM-DD dates: " + date);
+            }
+            v = v * 10 + (date[i] - '0');
+        }
+        return v;
+    };
+    int y = digits(0, 4), m = digits(5, 2), d = digits(8, 2);
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+string dateString(int32_t days) {
+    int z = days + 719468;
+    int era = (z >= 0 ? z : z - 146096) / 146097;
+    int doe = z - era * 146097;
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int mp = (5 * doy + 2) / 153;
+    int d = doy - (153 * mp + 2) / 5 + 1;
+    int m = mp + (mp < 10 ? 3 : -9);
+    int y = yoe + era * 400 + (m <= 2);
+    
+    char buf[10] = {0, 0, 0, 0, '-', 0, 0, '-', 0, 0};
+    for (int i = 3; i >= 0; i--, y /= 10) buf[i] = static_cast<char>('0' + y % 10);
+    buf[5] = static_cast<char>('0' + m / 10);
+    buf[6] = static_cast<char>('0' + m % 10);
+    buf[8] = static_cast<char>('0' + d / 10);
+    buf[9] = static_cast<char>('0' + d % 10);
+    return string(buf, 10);
+}
+
+// First value as a zigzag varint (it carries the absolute level), then per
+// frame: zigzag(min), bit width, (v - min) packed LSB-first. Ranges wider than
+// 56 bits are stored as raw 64-bit words.
+void packColumn(vector<uint8_t>& b, const vector<int64_t>& v) {
+    if (v.empty()) return;
+    putVarint(b, zigzag(v[0]));
+    
+    for (size_t start = 1; start < v.size(); start += FRAME) {
+        size_t end = min(start + FRAME, v.size());
+        int64_t lo = *min_element(v.begin() + start, v.begin() + end);
+        int64_t hi = *max_element(v.begin() + start, v.begin() + end);
+        uint64_t range = static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo);
+        int bits = range == 0 ? 0 : 64 - __builtin_clzll(range);
+        if (bits > 56) bits = 64;
+        
+        putVarint(b, zigzag(lo));
+        b.push_back(static_cast<uint8_t>(bits));
+        if (bits == 0) continue;
+        
+        if (bits == 64) {
+            for (size_t i = start; i < end; i++) {
+                uint64_t u = static_cast<uint64_t>(v[i]) - static_cast<uint64_t>(lo);
+                for (int k = 0; k < 8; k++) b.push_back(static_cast<uint8_t>(u >> (8 * k)));
+            }
+            continue;
+        }
+        
+        uint64_t acc = 0;
+        int filled = 0;
+        for (size_t i = start; i < end; i++) {
+            acc |= (static_cast<uint64_t>(v[i]) - static_cast<uint64_t>(lo)) << filled;
+            filled += bits;
+            while (filled >= 8) {
+                b.push_back(static_cast<uint8_t>(acc));
+                acc >>= 8;
+                filled -= 8;
+            }
+        }
+        if (filled > 0) b.push_back(static_cast<uint8_t>(acc));
+    }
+}
+
+// Unaligned 64-bit loads (little-endian); the footer after every block
+// guarantees 8 readable bytes past the last packed value
+template <typename T>
+const uint8_t* unpackColumn(const uint8_t* p, const uint8_t* end, size_t n, T* out) {
+    if (n == 0) return p;
+    out[0] = static_cast<T>(unzigzag(getVarint(p, end)));
+    
+    for (size_t start = 1; start < n; start += FRAME) {
+        size_t count = min(FRAME, n - start);
+        int64_t lo = unzigzag(getVarint(p, end));
+        if (p >= end) throw runtime_error("Corrupt trade archive (column)");
+        int bits = *p++;
+        size_t bytes = bits == 64 ? count * 8 : (count * bits + 7) / 8;
+        if (bits > 64 || static_cast<size_t>(end - p) < bytes + 8) {
+            throw runtime_error("Corrupt trade archive (column)");
+        }
+        
+        T* dst = out + start;
+        if (bits == 0) {
+            fill(dst, dst + count, static_cast<T>(lo));
+        } else if (bits == 64) {
+            for (size_t i = 0; i < count; i++) {
+                uint64_t u;
+                memcpy(&u, p + 8 * i, 8);
+                dst[i] = static_cast<T>(lo + static_cast<int64_t>(u));
+            }
+        } else {
+            const uint64_t mask = (uint64_t(1) << bits) - 1;
+            size_t bitPos = 0;
+            for (size_t i = 0; i < count; i++, bitPos += bits) {
+                uint64_t word;
+                memcpy(&word, p + (bitPos >> 3), 8);
+                dst[i] = static_cast<T>(lo + static_cast<int64_t>((word >> (bitPos & 7)) & mask));
+            }
+        }
+        p += bytes;
+    }
+    return p;
+}
+}
+
+double ArchivedLog::entryPrice(size_t i) const {
+    return fromUnits(entryCents[i], 100.0, (flags[i] >> ENTRY_PRICE_FLAG_SHIFT) & 7);
+}
+
+double ArchivedLog::exitPrice(size_t i) const {
+    return fromUnits(exitCents[i], 100.0, (flags[i] >> EXIT_PRICE_FLAG_SHIFT) & 7);
+}
+
+double ArchivedLog::shareCount(size_t i) const {
+    return fromUnits(shares[i], 10000.0, (flags[i] >> SHARES_FLAG_SHIFT) & 7);
+}
+
+double ArchivedLog::pnl(size_t i) const {
+    return fromUnits(pnlCents[i], 100.0, (flags[i] >> PNL_FLAG_SHIFT) & 7);
+}
+
+double ArchivedLog::returnPct(size_t i) const {
+    return fromUnits(returnBps[i], 100.0, (flags[i] >> RETURN_FLAG_SHIFT) & 7);
+}
+
+vector<Trade> ArchivedLog::toTrades() const {
+    vector<Trade> trades(size());
+    for (size_t i = 0; i < trades.size(); i++) {
+        Trade& t = trades[i];
+        t.entryDate = dateString(entryDay[i]);
+        t.exitDate = dateString(exitDay[i]);
+        t.entryPrice = entryPrice(i);
+        t.exitPrice = exitPrice(i);
+        t.shares = shareCount(i);
+        t.pnl = pnl(i);
+        t.returnPct = returnPct(i);
+        t.entryIndex = entryIndex[i];
+        t.exitIndex = exitIndex[i];
+        t.exitReason = reason(i);
+    }
+    return trades;
+}
+
+TradeArchiveWriter::TradeArchiveWriter(const string& filename)
+    : out(filename), offset(0), closed(false) {
+    if (out.isOpen()) {
+        out.bytes(TRADE_ARCHIVE_MAGIC, sizeof(TRADE_ARCHIVE_MAGIC));
+        offset = sizeof(TRADE_ARCHIVE_MAGIC);
+    }
+}
+
+TradeArchiveWriter::~TradeArchiveWriter() {
+    close();
+}
+
+void TradeArchiveWriter::emit(const vector<uint8_t>& bytes) {
+    out.bytes(bytes.data(), bytes.size());
+    offset += bytes.size();
+}
+
+void TradeArchiveWriter::add(const string& symbol, const vector<Trade>& trades) {
+    if (closed) throw runtime_error("Trade archive already closed");
+    
+    auto found = symbolIds.find(symbol);
+    uint32_t id;
+    if (found == symbolIds.end()) {
+        id = static_cast<uint32_t>(symbols.size());
+        symbolIds[symbol] = id;
+        symbols.push_back(symbol);
+    } else {
+        id = found->second;
+    }
+    index.push_back({id, trades.size(), offset});
+    
+    size_t n = trades.size();
+    vector<vector<int64_t>> cols(NUM_ARCHIVE_COLUMNS, vector<int64_t>(n));
+    int64_t prevDay = 0, prevBar = 0, prevCents = 0;
+    TradePredictor predict;
+    for (size_t i = 0; i < n; i++) {
+        const Trade& t = trades[i];
+        int64_t entryBar = static_cast<int64_t>(t.entryIndex);
+        int64_t exitBar = static_cast<int64_t>(t.exitIndex);
+        int64_t entryDay = dayNumber(t.entryDate);
+        int64_t exitDay = dayNumber(t.exitDate);
+        cols[COL_ENTRY_BAR_DELTA][i] = entryBar - prevBar;
+        cols[COL_HOLD_BARS][i] = exitBar - entryBar;
+        cols[COL_ENTRY_DAY_RESIDUAL][i] = entryDay - prevDay - impliedDays(entryBar - prevBar);
+        cols[COL_HOLD_DAY_RESIDUAL][i] = exitDay - entryDay - impliedDays(exitBar - entryBar);
+        prevBar = exitBar;
+        prevDay = exitDay;
+        
+        int entryCode, exitCode, sharesCode, pnlCode, returnCode;
+        int64_t entryCents = toUnits(t.entryPrice, 2, entryCode);
+        int64_t exitCents = toUnits(t.exitPrice, 2, exitCode);
+        int64_t shares = toUnits(t.shares, 4, sharesCode);
+        int64_t pnlCents = toUnits(t.pnl, 2, pnlCode);
+        int64_t returnBps = toUnits(t.returnPct, 2, returnCode);
+        cols[COL_ENTRY_PRICE_DELTA][i] = entryCents - prevCents;
+        cols[COL_EXIT_PRICE_DELTA][i] = exitCents - entryCents;
+        prevCents = exitCents;
+        
+        int64_t costs = impliedPnl(entryCents, exitCents, shares) - pnlCents;
+        cols[COL_SHARES_RESIDUAL][i] = shares - predict.shares(entryCents);
+        cols[COL_COST_RESIDUAL][i] = costs - predict.costs(exitCents, shares);
+        cols[COL_RETURN_RESIDUAL][i] = returnBps - impliedReturn(entryCents, shares, pnlCents);
+        cols[COL_FLAGS][i] = t.exitReason | sharesCode << SHARES_FLAG_SHIFT |
+                             pnlCode << PNL_FLAG_SHIFT | returnCode << RETURN_FLAG_SHIFT |
+                             entryCode << ENTRY_PRICE_FLAG_SHIFT | exitCode << EXIT_PRICE_FLAG_SHIFT;
+        predict.update(entryCents, exitCents, shares, pnlCents, costs);
+    }
+    
+    block.clear();
+    putVarint(block, n);
+    for (const auto& col : cols) packColumn(block, col);
+    emit(block);
+}
+
+bool TradeArchiveWriter::close() {
+    if (closed || !out.isOpen()) return out.ok();
+    closed = true;
+    
+    TradeArchiveTrailer trailer;
+    trailer.dictionaryOffset = offset;
+    block.clear();
+    putVarint(block, symbols.size());
+    for (const auto& s : symbols) {
+        putVarint(block, s.size());
+        block.insert(block.end(), s.begin(), s.end());
+    }
+    emit(block);
+    
+    trailer.indexOffset = offset;
+    block.clear();
+    for (const auto& e : index) {
+        putVarint(block, e.symbol);
+        putVarint(block, e.numTrades);
+        putVarint(block, e.offset);
+    }
+    emit(block);
+    
+    trailer.numLogs = index.size();
+    memcpy(trailer.magic, TRADE_ARCHIVE_MAGIC, sizeof(trailer.magic));
+    out.bytes(&trailer, sizeof(trailer));
+    offset += sizeof(trailer);
+    return out.close();
+}
+
+TradeArchiveReader::TradeArchiveReader(const string& filename) : file(filename) {
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(file.data());
+    size_t size = file.size();
+    if (size < sizeof(TRADE_ARCHIVE_MAGIC) + sizeof(TradeArchiveTrailer) ||
+        memcmp(base, TRADE_ARCHIVE_MAGIC, sizeof(TRADE_ARCHIVE_MAGIC)) != 0) {
+        throw runtime_error("Not a trade archive: " + filename);
+    }
+    
+    TradeArchiveTrailer trailer;
+    memcpy(&trailer, base + size - sizeof(trailer), sizeof(trailer));
+    size_t footerEnd = size - sizeof(trailer);
+    if (memcmp(trailer.magic, TRADE_ARCHIVE_MAGIC, sizeof(trailer.magic)) != 0 ||
+        trailer.dictionaryOffset > trailer.indexOffset || trailer.indexOffset > footerEnd) {
+        throw runtime_error("Truncated trade archive: " + filename);
+    }
+    
+    const uint8_t* p = base + trailer.dictionaryOffset;
+    const uint8_t* end = base + trailer.indexOffset;
+    size_t count = getVarint(p, end);
+    for (size_t i = 0; i < count; i++) {
+        size_t len = getVarint(p, end);
+        if (static_cast<size_t>(end - p) < len) throw runtime_error("Corrupt trade archive (dictionary)");
+        symbols.emplace_back(reinterpret_cast<const char*>(p), len);
+        p += len;
+    }
+    
+    p = base + trailer.indexOffset;
+    end = base + footerEnd;
+    for (uint64_t i = 0; i < trailer.numLogs; i++) {
+        LogEntry e;
+        e.symbol = static_cast<uint32_t>(getVarint(p, end));
+        e.numTrades = getVarint(p, end);
+        e.offset = getVarint(p, end);
+        if (e.symbol >= symbols.size() || e.offset >= trailer.dictionaryOffset) {
+            throw runtime_error("Corrupt trade archive (index)");
+        }
+        logs.push_back(e);
+    }
+}
+
+void TradeArchiveReader::decode(size_t log, ArchivedLog& out) const {
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(file.data());
+    const uint8_t* p = base + logs[log].offset;
+    const uint8_t* end = base + file.size();
+    size_t n = getVarint(p, end);
+    if (n != logs[log].numTrades) throw runtime_error("Corrupt trade archive (block)");
+    
+    out.entryDay.resize(n);
+    out.exitDay.resize(n);
+    out.entryIndex.resize(n);
+    out.exitIndex.resize(n);
+    out.entryCents.resize(n);
+    out.exitCents.resize(n);
+    out.shares.resize(n);
+    out.pnlCents.resize(n);
+    out.returnBps.resize(n);
+    out.flags.resize(n);
+    
+    // Unpack the residual columns in place (costs go through pnlCents), then
+    // one pass undoes the delta and prediction coding
+    p = unpackColumn(p, end, n, out.entryIndex.data());
+    p = unpackColumn(p, end, n, out.exitIndex.data());
+    p = unpackColumn(p, end, n, out.entryDay.data());
+    p = unpackColumn(p, end, n, out.exitDay.data());
+    p = unpackColumn(p, end, n, out.entryCents.data());
+    p = unpackColumn(p, end, n, out.exitCents.data());
+    p = unpackColumn(p, end, n, out.shares.data());
+    p = unpackColumn(p, end, n, out.pnlCents.data());
+    p = unpackColumn(p, end, n, out.returnBps.data());
+    p = unpackColumn(p, end, n, out.flags.data());
+    
+    int64_t prevDay = 0;
+    uint64_t prevBar = 0;
+    int64_t prevCents = 0;
+    TradePredictor predict;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t entryBarDelta = out.entryIndex[i];
+        out.entryIndex[i] += prevBar;
+        out.exitIndex[i] += out.entryIndex[i];
+        prevBar = out.exitIndex[i];
+        
+        int64_t entryDay = prevDay + out.entryDay[i] + impliedDays(static_cast<int64_t>(entryBarDelta));
+        int64_t exitDay = entryDay + out.exitDay[i] +
+                          impliedDays(static_cast<int64_t>(out.exitIndex[i] - out.entryIndex[i]));
+        out.entryDay[i] = static_cast<int32_t>(entryDay);
+        out.exitDay[i] = static_cast<int32_t>(exitDay);
+        prevDay = exitDay;
+        
+        int64_t entryCents = prevCents + out.entryCents[i];
+        int64_t exitCents = entryCents + out.exitCents[i];
+        out.entryCents[i] = entryCents;
+        out.exitCents[i] = exitCents;
+        prevCents = exitCents;
+        
+        int64_t shares = out.shares[i] + predict.shares(entryCents);
+        int64_t costs = out.pnlCents[i] + predict.costs(exitCents, shares);
+        int64_t pnlCents = impliedPnl(entryCents, exitCents, shares) - costs;
+        out.shares[i] = shares;
+        out.pnlCents[i] = pnlCents;
+        out.returnBps[i] += impliedReturn(entryCents, shares, pnlCents);
+        predict.update(entryCents, exitCents, shares, pnlCents, costs);
+    }
+}
+
+vector<Trade> TradeArchiveReader::trades(size_t log) const {
+    ArchivedLog decoded;
+    decode(log, decoded);
+    return decoded.toTrades();
+}
+
+bool TradeArchiveReader::toCSV(const string& filename) const {
+    ReportWriter out(filename);
+    if (!out.isOpen()) return false;
+    
+    out.text("Symbol,Entry Date,Exit Date,Entry Price,Exit Price,Shares,P&L,Return %\n");
+    ArchivedLog decoded;
+    for (size_t log = 0; log < logs.size(); log++) {
+        decode(log, decoded);
+        const string& sym = symbol(log);
+        for (size_t i = 0; i < decoded.size(); i++) {
+            out.text(sym).put(',')
+                .text(dateString(decoded.entryDay[i])).put(',')
+                .text(dateString(decoded.exitDay[i])).put(',')
+                .fixed(decoded.entryPrice(i), 2).put(',')
+                .fixed(decoded.exitPrice(i), 2).put(',')
+                .fixed(decoded.shareCount(i), 4).put(',')
+                .fixed(decoded.pnl(i), 2).put(',')
+                .fixed(decoded.returnPct(i), 2).text("%\n");
+        }
+    }
+    return out.close();
+}
@@ -0,0 +1,317 @@
+#include "../include/UniverseReport.hpp"
+#include "../include/CSVParser.hpp"
+#include "../include/Backtester.hpp"
+#include "../include/ReportWriter.hpp"
+#include "../include/Tracer.hpp"
+#include "../include/RuntimeMetrics.hpp"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <atomic>
+#include <map>
+#include <cmath>
+using namespace std;
+
+namespace {
+struct DateAccum {
+    double sumReturn = 0.0;
+    int count = 0;
+};
+
+// Everything one worker produces; merged pairwise after the run
+struct Partial {
+    vector<SymbolSummary> symbols;
+    vector<string> skipped;
+    map<string, DateAccum> byDate;
+};
+
+void mergeInto(Partial& dst, Partial& src) {
+    Tracer::setThreadName("merge");
+    TRACE_SCOPE("merge");
+    move(src.symbols.begin(), src.symbols.end(), back_inserter(dst.symbols));
+    move(src.skipped.begin(), src.skipped.end(), back_inserter(dst.skipped));
+    for (auto& entry : src.byDate) {
+        DateAccum& acc = dst.byDate[entry.first];
+        acc.sumReturn += entry.second.sumReturn;
+        acc.count += entry.second.count;
+    }
+    src = Partial();
+}
+
+string symbolName(const string& path) {
+    return filesystem::path(path).stem().string();
+}
+
+void runSymbol(const string& file, const BacktestConfig& c, Partial& out) {
+    string symbol = symbolName(file);
+    TRACE_SCOPE("symbol", symbol.c_str());
+    vector<OHLCV> data;
+    try {
+        data = CSVParser::parse(file);
+    } catch (const exception& e) {
+        out.skipped.push_back(symbol + ": " + e.what());
+        return;
+    }
+    if (data.size() <= static_cast<size_t>(max(c.shortMA, c.longMA))) {
+        out.skipped.push_back(symbol + ": insufficient data");
+        return;
+    }
+    
+    Backtester bt(data, c.shortMA, c.longMA, c.initialCapital, c.useRSI, c.useEMA, c.useMACD,
+                  c.useBollinger, c.stopLoss, c.takeProfit, c.commission, c.useKelly, c.slippage);
+    bt.run();
+    BacktestResult result = bt.getResult();
+    out.symbols.push_back({symbol, data.front().date, data.back().date,
+                           result.finalValue, result.metrics});
+    
+    vector<double> returns = bt.getBarReturns();
+    for (size_t i = 1; i < data.size(); i++) {
+        DateAccum& acc = out.byDate[data[i].date];
+        acc.sumReturn += returns[i];
+        acc.count++;
+    }
+}
+
+double interpolate(double lo, double hi, double frac) {
+    return lo + (hi - lo) * frac;
+}
+
+// q-quantile with linear interpolation; partitions values in place
+double quantile(vector<double>& values, double q) {
+    double pos = q * (values.size() - 1);
+    size_t k = static_cast<size_t>(pos);
+    nth_element(values.begin(), values.begin() + k, values.end());
+    double lo = values[k];
+    if (k + 1 >= values.size()) return lo;
+    // Next order statistic is the minimum of the upper partition
+    double hi = *min_element(values.begin() + k + 1, values.end());
+    return interpolate(lo, hi, pos - k);
+}
+
+void writeDistribution(ReportWriter& file, const char* name, const Distribution& d) {
+    file.text(name).put(',')
+        .fixed(d.min, 2).put(',').fixed(d.p25, 2).put(',').fixed(d.median, 2).put(',')
+        .fixed(d.p75, 2).put(',').fixed(d.max, 2).put(',')
+        .fixed(d.mean, 2).put(',').fixed(d.stdDev, 2).put('\n');
+}
+
+void printDistribution(const char* name, const Distribution& d) {
+    cout << left << setw(16) << name
+         << right << fixed << setprecision(2)
+         << setw(10) << d.min
+         << setw(10) << d.p25
+         << setw(10) << d.median
+         << setw(10) << d.p75
+         << setw(10) << d.max
+         << setw(10) << d.stdDev << "\n";
+}
+}
+
+vector<string> UniverseReport::listFiles(const string& directory) {
+    vector<string> files;
+    for (const auto& entry : filesystem::directory_iterator(directory)) {
+        if (!entry.is_regular_file()) continue;
+        string ext = entry.path().extension().string();
+        transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if (ext == ".csv") files.push_back(entry.path().string());
+    }
+    sort(files.begin(), files.end());
+    return files;
+}
+
+UniverseSummary UniverseReport::run(const vector<string>& files,
+                                    const BacktestConfig& config,
+                                    unsigned threads) {
+    threads = max(1u, min<unsigned>(threads, static_cast<unsigned>(files.size())));
+    vector<Partial> partials(threads);
+    
+    // Symbols differ widely in length: hand them out one at a time
+    atomic<size_t> next(0);
+    RuntimeMetrics::add(METRIC_SYMBOLS_QUEUED, files.size());
+    vector<thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            Tracer::setThreadName("universe worker " + to_string(t));
+            size_t i;
+            while ((i = next.fetch_add(1)) < files.size()) {
+                runSymbol(files[i], config, partials[t]);
+                RuntimeMetrics::add(METRIC_SYMBOLS_DONE);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    
+    // Tree reduction: log2(threads) rounds of independent pairwise merges
+    for (size_t step = 1; step < partials.size(); step *= 2) {
+        vector<thread> mergers;
+        for (size_t i = 0; i + step < partials.size(); i += 2 * step) {
+            mergers.emplace_back(mergeInto, ref(partials[i]), ref(partials[i + step]));
+        }
+        for (auto& m : mergers) m.join();
+    }
+    Partial& all = partials[0];
+    
+    UniverseSummary s;
+    s.symbols = move(all.symbols);
+    s.skipped = move(all.skipped);
+    sort(s.symbols.begin(), s.symbols.end(),
+         [](const SymbolSummary& a, const SymbolSummary& b) { return a.symbol < b.symbol; });
+    sort(s.skipped.begin(), s.skipped.end());
+    
+    vector<double> values(s.symbols.size());
+    auto collect = [&](double PerformanceMetrics::*field) -> Distribution {
+        for (size_t i = 0; i < s.symbols.size(); i++) values[i] = s.symbols[i].metrics.*field;
+        return distribution(values);
+    };
+    s.totalReturn = collect(&PerformanceMetrics::totalReturn);
+    s.cagr = collect(&PerformanceMetrics::cagr);
+    s.maxDrawdown = collect(&PerformanceMetrics::maxDrawdown);
+    s.sharpe = collect(&PerformanceMetrics::sharpeRatio);
+    
+    // Equal-weight curve from the merged per-date return sums
+    PerformanceMetrics& m = s.combined;
+    m = PerformanceMetrics();
+    double value = 1.0, peak = 1.0, sumRet = 0.0, sumRetSq = 0.0;
+    s.dates.reserve(all.byDate.size());
+    s.equity.reserve(all.byDate.size());
+    s.constituents.reserve(all.byDate.size());
+    for (const auto& entry : all.byDate) {
+        double r = entry.second.sumReturn / entry.second.count;
+        value *= 1.0 + r;
+        sumRet += r;
+        sumRetSq += r * r;
+        peak = max(peak, value);
+        m.maxDrawdown = max(m.maxDrawdown, (peak - value) / peak * 100.0);
+        s.dates.push_back(entry.first);
+        s.equity.push_back(value);
+        s.constituents.push_back(entry.second.count);
+    }
+    
+    m.totalReturn = (value - 1.0) * 100.0;
+    if (!s.dates.empty()) {
+        double years = stoi(s.dates.back().substr(0, 4)) - stoi(s.dates.front().substr(0, 4));
+        if (years <= 0) years = 1.0;
+        m.cagr = (pow(value, 1.0 / years) - 1.0) * 100.0;
+        
+        double n = static_cast<double>(s.dates.size());
+        double mean = sumRet / n;
+        double stdDev = sqrt(max(0.0, sumRetSq / n - mean * mean));
+        m.sharpeRatio = stdDev > 0 ? mean / stdDev * sqrt(252.0) : 0.0;
+    }
+    for (const auto& sym : s.symbols) {
+        m.numTrades += sym.metrics.numTrades;
+        m.winningTrades += sym.metrics.winningTrades;
+    }
+    m.winRate = m.numTrades > 0 ? m.winningTrades * 100.0 / m.numTrades : 0.0;
+    return s;
+}
+
+Distribution UniverseReport::distribution(vector<double>& values) {
+    Distribution d = {0, 0, 0, 0, 0, 0, 0};
+    if (values.empty()) return d;
+    
+    double sum = 0.0, sumSq = 0.0;
+    d.min = d.max = values[0];
+    for (double v : values) {
+        sum += v;
+        sumSq += v * v;
+        d.min = min(d.min, v);
+        d.max = max(d.max, v);
+    }
+    double n = static_cast<double>(values.size());
+    d.mean = sum / n;
+    d.stdDev = sqrt(max(0.0, sumSq / n - d.mean * d.mean));
+    
+    d.median = quantile(values, 0.50);
+    d.p25 = quantile(values, 0.25);
+    d.p75 = quantile(values, 0.75);
+    return d;
+}
+
+bool UniverseReport::writeCSV(const string& filename, const UniverseSummary& s) {
+    filesystem::path parent = filesystem::path(filename).parent_path();
+    error_code ec;
+    if (!parent.empty()) filesystem::create_directories(parent, ec);
+    ReportWriter file(filename);
+    if (!file.isOpen()) return false;
+    
+    file.text("UNIVERSE SUMMARY\n");
+    file.text("================\n\n");
+    file.text("Symbols,").integer(s.symbols.size()).put('\n');
+    file.text("Skipped,").integer(s.skipped.size()).put('\n');
+    file.text("Equal-Weight Return,").fixed(s.combined.totalReturn, 2).text("%\n");
+    file.text("Equal-Weight CAGR,").fixed(s.combined.cagr, 2).text("%\n");
+    file.text("Equal-Weight Max Drawdown,").fixed(s.combined.maxDrawdown, 2).text("%\n");
+    file.text("Equal-Weight Sharpe,").fixed(s.combined.sharpeRatio, 3).put('\n');
+    file.text("Total Trades,").integer(s.combined.numTrades).put('\n');
+    file.text("Win Rate,").fixed(s.combined.winRate, 2).text("%\n\n");
+    
+    file.text("DISTRIBUTIONS\n");
+    file.text("=============\n");
+    file.text("Metric,Min,P25,Median,P75,Max,Mean,StdDev\n");
+    writeDistribution(file, "Total Return %", s.totalReturn);
+    writeDistribution(file, "CAGR %", s.cagr);
+    writeDistribution(file, "Max Drawdown %", s.maxDrawdown);
+    writeDistribution(file, "Sharpe", s.sharpe);
+    file.put('\n');
+    
+    file.text("PER-SYMBOL RESULTS\n");
+    file.text("==================\n");
+    file.text("Symbol,First Date,Last Date,Final Value,Total Return %,CAGR %,Max Drawdown %,Sharpe,Trades,Win Rate %\n");
+    for (const auto& sym : s.symbols) {
+        const auto& m = sym.metrics;
+        file.text(sym.symbol).put(',').text(sym.firstDate).put(',').text(sym.lastDate).put(',')
+            .fixed(sym.finalValue, 2).put(',')
+            .fixed(m.totalReturn, 2).put(',').fixed(m.cagr, 2).put(',')
+            .fixed(m.maxDrawdown, 2).put(',').fixed(m.sharpeRatio, 3).put(',')
+            .integer(m.numTrades).put(',').fixed(m.winRate, 2).put('\n');
+    }
+    for (const auto& reason : s.skipped) {
+        file.text("# skipped ").text(reason).put('\n');
+    }
+    file.put('\n');
+    
+    file.text("EQUAL-WEIGHT EQUITY\n");
+    file.text("===================\n");
+    file.text("Date,Equity,Constituents\n");
+    for (size_t i = 0; i < s.dates.size(); i++) {
+        file.text(s.dates[i]).put(',').fixed(s.equity[i], 6).put(',')
+            .integer(s.constituents[i]).put('\n');
+    }
+    return file.close();
+}
+
+void UniverseReport::printSummary(const UniverseSummary& s) {
+    cout << "\n=== UNIVERSE RESULTS ===\n";
+    cout << "Symbols: " << s.symbols.size();
+    if (!s.skipped.empty()) cout << " (" << s.skipped.size() << " skipped)";
+    cout << "\n";
+    if (!s.dates.empty()) {
+        cout << "Period: " << s.dates.front() << " to " << s.dates.back() << "\n";
+    }
+    cout << fixed << setprecision(2);
+    cout << "Equal-Weight Return: " << s.combined.totalReturn << "%\n";
+    cout << "Equal-Weight CAGR: " << s.combined.cagr << "%\n";
+    cout << "Equal-Weight Max Drawdown: " << s.combined.maxDrawdown << "%\n";
+    cout << "Equal-Weight Sharpe: " << setprecision(3) << s.combined.sharpeRatio << "\n";
+    cout << "Total Trades: " << s.combined.numTrades << "\n";
+    
+    cout << "\n" << left << setw(16) << "Metric"
+         << right << setw(10) << "Min"
+         << setw(10) << "P25"
+         << setw(10) << "Median"
+         << setw(10) << "P75"
+         << setw(10) << "Max"
+         << setw(10) << "StdDev" << "\n";
+    cout << string(76, '-') << "\n";
+    printDistribution("Total Return %", s.totalReturn);
+    printDistribution("CAGR %", s.cagr);
+    printDistribution("Max Drawdown %", s.maxDrawdown);
+    printDistribution("Sharpe", s.sharpe);
+    
+    for (const auto& reason : s.skipped) {
+        cerr << "Skipped " << reason << "\n";
+    }
+}
@@ -1,13 +1,37 @@
 #include "../include/CSVParser.hpp"
 #include "../include/TechnicalIndicators.hpp"
 #include "../include/Backtester.hpp"
+#include "../include/RegimeDetector.hpp"
+#include "../include/PortfolioOptimizer.hpp"
+#include "../include/ResultStore.hpp"
+#include "../include/BinaryResultReader.hpp"
+#include "../include/AsyncResultWriter.hpp"
+#include "../include/ResultExport.hpp"
+#include "../include/JsonWriter.hpp"
+#include "../include/UniverseReport.hpp"
+#include "../include/HtmlReport.hpp"
+#include "../include/TradeArchive.hpp"
+#include "../include/ResultCache.hpp"
+#include "../include/Profiler.hpp"
+#include "../include/Tracer.hpp"
+#include "../include/SamplingProfiler.hpp"
+#include "../include/MetricsServer.hpp"
+#include "../include/PerfCounters.hpp"
 #include <iostream>
 #include <iomanip>
 #include <vector>
 #include <string>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <filesystem>
+#include <chrono>
+#include <cmath>
 using namespace std;
 void printUsage(const char* programName) {
-    cout << "Usage: " << programName << " <csv_file> [options]\n\n";
+    cout << "Usage: " << programName << " <csv_file> [options]\n";
+    cout << "       " << programName << " --convert <results.btr> <results.csv|report.html>\n";
+    cout << "       " << programName << " --convert <trades.bta> <trades.csv>\n\n";
     cout << "Options:\n";
     cout << "  --short <n>        Short MA period (default: 50)\n";
     cout << "  --long <n>         Long MA period (default: 200)\n";
@@ -19,17 +43,94 @@ void printUsage(const char* programName) {
     cout << "  --stoploss <n>     Stop loss percentage (e.g., 0.05 for 5%)\n";
     cout << "  --takeprofit <n>   Take profit percentage (e.g., 0.15 for 15%)\n";
     cout << "  --commission <n>   Commission rate (default: 0.001 for 0.1%)\n";
+    cout << "  --slippage <n>     Slippage per fill as a fraction of price (default: 0)\n";
     cout << "  --kelly            Use Kelly Criterion for position sizing\n";
     cout << "  --compare          Run strategy comparison across multiple MA periods\n";
+    cout << "  --portfolio        Combine comparison strategies into optimized portfolios\n";
+    cout << "  --maxweight <n>    Max weight per strategy in portfolio (default: 1.0)\n";
+    cout << "  --cost-sweep <l>   Re-price the run at comma-separated commission rates\n";
+    cout << "  --regimes          Break down performance by volatility/trend regime\n";
     cout << "  --output <file>    Output results file (default: results.csv)\n";
+    cout << "  --series <file>    Record per-bar equity/position/indicators and export as CSV\n";
+    cout << "  --series-map <f>   Record per-bar equity/cash/position/drawdown into a mapped file\n";
+    cout << "  --binary <file>    Also export results in the binary (.btr) format\n";
+    cout << "  --json <file>      Also export results as one JSON document\n";
+    cout << "  --ndjson <file>    Write one JSON line per run (comparison, main run, cost sweep)\n";
+    cout << "  --html <file>      Write a self-contained HTML report with equity/drawdown charts\n";
+    cout << "  --archive <file>   Write the trade log to a compact archive (.bta)\n";
+    cout << "  --cache <dir>      Reuse results of identical runs from a content-addressed cache\n";
+    cout << "  --profile          Print time and hardware counters per stage (parse, indicators, loop, metrics, export)\n";
+    cout << "  --trace <file>     Write a per-thread timeline in Chrome trace format (chrome://tracing, Perfetto)\n";
+    cout << "  --sample-profile <f> Sample CPU stacks and write them collapsed for flame graphs\n";
+    cout << "  --sample-hz <n>    Sampling rate for --sample-profile (default: 99)\n";
+    cout << "  --metrics-port <n> Serve live progress counters at http://127.0.0.1:<n>/metrics\n";
+    cout << "  --store <file>     Append run results to a columnar result store\n";
+    cout << "  --top <k>          Query the store for the k best runs\n";
+    cout << "  --sort <column>    Ranking column for --top (default: sharpe)\n";
+    cout << "  --index            Rebuild the stored index of the --sort column after appending\n";
+    cout << "  --max-dd <n>       Only rank runs with max drawdown below n %\n";
+    cout << "  --universe         Treat <csv_file> as a directory and backtest every CSV in it\n";
+    cout << "  --threads <n>      Worker threads for --universe (default: all cores)\n";
     cout << "\nExamples:\n";
     cout << "  " << programName << " data/AAPL.csv\n";
     cout << "  " << programName << " data/AAPL.csv --short 20 --long 50 --ema\n";
     cout << "  " << programName << " data/AAPL.csv --stoploss 0.05 --takeprofit 0.15 --kelly\n";
     cout << "  " << programName << " data/AAPL.csv --compare\n";
+    cout << "  " << programName << " data --universe --output results/universe.csv\n";
 }
 
-void runStrategyComparison(const vector<OHLCV>& data, double capital) {
+// A machine-readable output written to stdout ("-") must stay parseable, so
+// every human-readable line goes to stderr instead
+void keepStdoutForData(const vector<string>& outputs) {
+    for (const auto& f : outputs) {
+        if (f == "-") {
+            cout.rdbuf(cerr.rdbuf());
+            return;
+        }
+    }
+}
+
+bool hasExtension(const string& path, const string& ext) {
+    return path.size() >= ext.size() && path.compare(path.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+void printPortfolio(const string& method, const PortfolioWeights& p,
+                    const vector<StrategyParams>& strategies) {
+    cout << left << setw(20) << method
+              << right << fixed << setprecision(1)
+              << setw(10) << p.expectedReturn
+              << setw(10) << p.volatility
+              << setw(10) << setprecision(2) << p.sharpeRatio
+              << setw(10) << setprecision(1) << p.riskSpread << "   ";
+    for (size_t i = 0; i < strategies.size(); i++) {
+        cout << strategies[i].name << "=" << setprecision(1) << p.weights[i] * 100.0 << "% ";
+    }
+    cout << "\n";
+}
+
+// One NDJSON record per run; trades are left to the full --json document
+void writeRunRecord(JsonWriter* json, const char* kind, const string& name,
+                    const BacktestResult& result) {
+    if (!json) return;
+    json->beginObject().key("run").value(kind);
+    if (!name.empty()) json->key("name").value(name);
+    ResultExport::jsonFields(*json, result, false);
+    json->endObject().endRecord();
+}
+
+// Copy without the O(bars) series, for exports that never read them
+BacktestResult withoutSeries(const BacktestResult& result) {
+    BacktestResult summary;
+    summary.config = result.config;
+    summary.finalValue = result.finalValue;
+    summary.metrics = result.metrics;
+    summary.trades = result.trades;
+    return summary;
+}
+
+void runStrategyComparison(const vector<OHLCV>& data, double capital,
+                           bool optimizePortfolio, double maxWeight,
+                           ResultStore* store, JsonWriter* ndjson) {
     cout << "\n=== STRATEGY COMPARISON ===\n";
     cout << "Testing multiple parameter combinations...\n\n";
     
@@ -47,10 +148,19 @@ void runStrategyComparison(const vector<OHLCV>& data, double capital) {
               << setw(12) << "Max DD %\n";
     cout << string(64, '-') << "\n";
     
+    vector<vector<double>> sleeveReturns;
     for (const auto& strategy : strategies) {
+        TRACE_SCOPE("backtest", strategy.name.c_str());
         Backtester bt(data, strategy.shortMA, strategy.longMA, capital, false);
         bt.run();
         auto metrics = bt.calculateMetrics();
+        if (optimizePortfolio) {
+            sleeveReturns.push_back(bt.getBarReturns());
+        }
+        if (store) {
+            store->append(bt.getConfig(), metrics);
+        }
+        writeRunRecord(ndjson, "compare", strategy.name, bt.getResult());
         
         cout << left << setw(20) << strategy.name 
                   << right << fixed << setprecision(1)
@@ -60,6 +170,138 @@ void runStrategyComparison(const vector<OHLCV>& data, double capital) {
                   << setw(12) << setprecision(1) << metrics.maxDrawdown << "\n";
     }
     cout << "\n";
+    
+    if (optimizePortfolio) {
+        PortfolioOptimizer optimizer(sleeveReturns);
+        PortfolioConstraints constraints;
+        constraints.maxWeight = maxWeight;
+        
+        cout << "=== PORTFOLIO OPTIMIZATION ===\n";
+        cout << left << setw(20) << "Method"
+                  << right << setw(10) << "Return %"
+                  << setw(10) << "Vol %"
+                  << setw(10) << "Sharpe"
+                  << setw(10) << "RC Sprd" << "   Weights\n";
+        cout << string(74, '-') << "\n";
+        printPortfolio("Minimum Variance", optimizer.minimumVariance(constraints), strategies);
+        printPortfolio("Risk Parity", optimizer.riskParity(constraints), strategies);
+        printPortfolio("Max Sharpe", optimizer.maxSharpe(constraints), strategies);
+        cout << "\n";
+    }
+}
+
+void printRegimeBreakdown(const vector<OHLCV>& data, const Backtester& bt) {
+    vector<double> closes;
+    closes.reserve(data.size());
+    for (const auto& bar : data) {
+        closes.push_back(bar.close);
+    }
+    
+    auto labels = RegimeDetector::label(closes);
+    auto perRegime = bt.calculateRegimeMetrics(labels, NUM_REGIMES);
+    
+    vector<size_t> barCounts(NUM_REGIMES, 0);
+    for (int r : labels) barCounts[r]++;
+    
+    cout << "\n=== REGIME BREAKDOWN ===\n";
+    cout << left << setw(20) << "Regime"
+              << right << setw(8) << "Bars"
+              << setw(12) << "Return %"
+              << setw(10) << "Trades"
+              << setw(10) << "Sharpe"
+              << setw(12) << "Max DD %\n";
+    cout << string(72, '-') << "\n";
+    
+    for (int r = 0; r < NUM_REGIMES; r++) {
+        const auto& metrics = perRegime[r];
+        cout << left << setw(20) << RegimeDetector::name(r)
+                  << right << setw(8) << barCounts[r]
+                  << fixed << setprecision(1)
+                  << setw(12) << metrics.totalReturn
+                  << setw(10) << metrics.numTrades
+                  << setw(10) << setprecision(2) << metrics.sharpeRatio
+                  << setw(12) << setprecision(1) << metrics.maxDrawdown << "\n";
+    }
+}
+
+// Comma-separated commission rates; throws invalid_argument on an empty,
+// malformed or negative entry so option parsing reports it up front
+vector<double> parseRates(const string& list) {
+    vector<double> rates;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == string::npos) end = list.size();
+        string item = list.substr(start, end - start);
+        size_t used = 0;
+        double rate = item.empty() ? -1.0 : stod(item, &used);
+        if (used != item.size() || !(rate >= 0.0) || std::isinf(rate)) {
+            throw invalid_argument("bad rate");
+        }
+        rates.push_back(rate);
+        start = end + 1;
+    }
+    return rates;
+}
+
+void runCostSweep(const Backtester& bt, const vector<double>& rates, JsonWriter* ndjson) {
+    // Signals do not depend on costs: replay the recorded fills instead of re-running
+    Backtester sweep = bt;
+    double slippage = bt.getConfig().slippage;
+    
+    cout << "\n=== COST SWEEP ===\n";
+    cout << right << setw(14) << "Commission %"
+              << setw(12) << "Return %"
+              << setw(10) << "CAGR %"
+              << setw(10) << "Sharpe"
+              << setw(12) << "Max DD %\n";
+    cout << string(58, '-') << "\n";
+    
+    for (double rate : rates) {
+        sweep.reprice(rate, slippage);
+        auto metrics = sweep.calculateMetrics();
+        cout << fixed << setprecision(3) << setw(14) << rate * 100.0
+                  << setprecision(1)
+                  << setw(12) << metrics.totalReturn
+                  << setw(10) << metrics.cagr
+                  << setw(10) << setprecision(2) << metrics.sharpeRatio
+                  << setw(12) << setprecision(1) << metrics.maxDrawdown << "\n";
+        writeRunRecord(ndjson, "reprice", "", sweep.getResult());
+    }
+}
+
+void printTopResults(ResultStore& store, ResultColumn sortColumn, size_t k, double maxDrawdown) {
+    vector<ResultFilter> filters;
+    if (maxDrawdown > 0) {
+        filters.push_back({COL_MAX_DRAWDOWN, -1.0, maxDrawdown});
+    }
+    // A stale index is not rebuilt here: topK() scans the mapped column instead
+    auto top = store.topK(sortColumn, k, filters);
+    
+    cout << "\n=== TOP " << k << " BY " << ResultStore::columnName(sortColumn)
+         << " (" << store.size() << " stored runs) ===\n";
+    cout << right << setw(8) << "Run"
+              << setw(8) << "Short"
+              << setw(8) << "Long"
+              << setw(10) << "Slip %"
+              << setw(12) << "Return %"
+              << setw(10) << "Trades"
+              << setw(10) << "Sharpe"
+              << setw(12) << "Max DD %\n";
+    cout << string(78, '-') << "\n";
+    
+    for (const auto& r : top) {
+        cout << setw(8) << r.id
+                  << setw(8) << r.config.shortMA
+                  << setw(8) << r.config.longMA
+                  << fixed << setprecision(3)
+                  << setw(10) << r.config.slippage * 100
+                  << setprecision(1)
+                  << setw(12) << r.metrics.totalReturn
+                  << setw(10) << r.metrics.numTrades
+                  << setw(10) << setprecision(2) << r.metrics.sharpeRatio
+                  << setw(12) << setprecision(1) << r.metrics.maxDrawdown << "\n";
+    }
 }
 
 int main(int argc, char* argv[]) {
@@ -68,6 +310,39 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    // Binary results -> human-readable CSV
+    if (string(argv[1]) == "--convert") {
+        if (argc < 4) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        try {
+            string out = argv[3];
+            keepStdoutForData({out});
+            if (hasExtension(argv[2], ".bta")) {
+                TradeArchiveReader archive(argv[2]);
+                if (!archive.toCSV(out)) {
+                    throw runtime_error("Cannot write " + out);
+                }
+                cout << "Converted " << argv[2] << " (" << archive.numLogs() << " trade logs) to "
+                     << out << "\n";
+                return 0;
+            }
+            
+            BinaryResultReader reader(argv[2]);
+            bool html = hasExtension(out, ".html");
+            if (html ? !HtmlReport::write(out, reader.toResult(true)) : !reader.toCSV(out)) {
+                throw runtime_error(string("Cannot write ") + argv[3]);
+            }
+            cout << "Converted " << argv[2] << " (" << reader.numTrades() << " trades, "
+                 << reader.numBars() << " bars) to " << argv[3] << "\n";
+        } catch (const exception& e) {
+            cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    
     // Parse command line arguments
     string filename = argv[1];
     int shortMA = 50;
@@ -80,39 +355,189 @@ int main(int argc, char* argv[]) {
     double stopLoss = 0.0;
     double takeProfit = 0.0;
     double commission = 0.001;
+    double slippage = 0.0;
     bool useKelly = false;
     bool runComparison = false;
-    string outputFile = "results/results.csv";
+    bool showRegimes = false;
+    vector<double> costSweep;
+    bool optimizePortfolio = false;
+    double maxWeight = 1.0;
+    string outputFile;
+    string storeFile;
+    string binaryFile;
+    string seriesFile;
+    string seriesMapFile;
+    string jsonFile;
+    string ndjsonFile;
+    string htmlFile;
+    string archiveFile;
+    string cacheDir;
+    bool profile = false;
+    string traceFile;
+    string sampleFile;
+    int sampleHz = SamplingProfiler::DEFAULT_HZ;
+    int metricsPort = -1;
+    size_t topK = 0;
+    string sortColumnName = "sharpe";
+    double maxDrawdownFilter = 0.0;
+    bool rebuildIndex = false;
+    bool universe = false;
+    unsigned threads = thread::hardware_concurrency();
     
     for (int i = 2; i < argc; i++) {
         string arg = argv[i];
         
-        if (arg == "--short" && i + 1 < argc) {
-            shortMA = stoi(argv[++i]);
-        } else if (arg == "--long" && i + 1 < argc) {
-            longMA = stoi(argv[++i]);
-        } else if (arg == "--capital" && i + 1 < argc) {
-            capital = stod(argv[++i]);
-        } else if (arg == "--rsi") {
-            useRSI = true;
-        } else if (arg == "--ema") {
-            useEMA = true;
-        } else if (arg == "--macd") {
-            useMACD = true;
-        } else if (arg == "--bollinger") {
-            useBollinger = true;
-        } else if (arg == "--stoploss" && i + 1 < argc) {
-            stopLoss = stod(argv[++i]);
-        } else if (arg == "--takeprofit" && i + 1 < argc) {
-            takeProfit = stod(argv[++i]);
-        } else if (arg == "--commission" && i + 1 < argc) {
-            commission = stod(argv[++i]);
-        } else if (arg == "--kelly") {
-            useKelly = true;
-        } else if (arg == "--compare") {
-            runComparison = true;
-        } else if (arg == "--output" && i + 1 < argc) {
-            outputFile = argv[++i];
+        try {
+            if (arg == "--short" && i + 1 < argc) {
+                shortMA = stoi(argv[++i]);
+            } else if (arg == "--long" && i + 1 < argc) {
+                longMA = stoi(argv[++i]);
+            } else if (arg == "--capital" && i + 1 < argc) {
+                capital = stod(argv[++i]);
+            } else if (arg == "--rsi") {
+                useRSI = true;
+            } else if (arg == "--ema") {
+                useEMA = true;
+            } else if (arg == "--macd") {
+                useMACD = true;
+            } else if (arg == "--bollinger") {
+                useBollinger = true;
+            } else if (arg == "--stoploss" && i + 1 < argc) {
+                stopLoss = stod(argv[++i]);
+            } else if (arg == "--takeprofit" && i + 1 < argc) {
+                takeProfit = stod(argv[++i]);
+            } else if (arg == "--commission" && i + 1 < argc) {
+                commission = stod(argv[++i]);
+            } else if (arg == "--slippage" && i + 1 < argc) {
+                slippage = stod(argv[++i]);
+            } else if (arg == "--kelly") {
+                useKelly = true;
+            } else if (arg == "--compare") {
+                runComparison = true;
+            } else if (arg == "--portfolio") {
+                optimizePortfolio = true;
+            } else if (arg == "--maxweight" && i + 1 < argc) {
+                maxWeight = stod(argv[++i]);
+            } else if (arg == "--cost-sweep" && i + 1 < argc) {
+                costSweep = parseRates(argv[++i]);
+            } else if (arg == "--regimes") {
+                showRegimes = true;
+            } else if (arg == "--output" && i + 1 < argc) {
+                outputFile = argv[++i];
+            } else if (arg == "--series" && i + 1 < argc) {
+                seriesFile = argv[++i];
+            } else if (arg == "--series-map" && i + 1 < argc) {
+                seriesMapFile = argv[++i];
+            } else if (arg == "--binary" && i + 1 < argc) {
+                binaryFile = argv[++i];
+            } else if (arg == "--json" && i + 1 < argc) {
+                jsonFile = argv[++i];
+            } else if (arg == "--ndjson" && i + 1 < argc) {
+                ndjsonFile = argv[++i];
+            } else if (arg == "--html" && i + 1 < argc) {
+                htmlFile = argv[++i];
+            } else if (arg == "--archive" && i + 1 < argc) {
+                archiveFile = argv[++i];
+            } else if (arg == "--profile") {
+                profile = true;
+            } else if (arg == "--trace" && i + 1 < argc) {
+                traceFile = argv[++i];
+            } else if (arg == "--sample-profile" && i + 1 < argc) {
+                sampleFile = argv[++i];
+            } else if (arg == "--sample-hz" && i + 1 < argc) {
+                sampleHz = stoi(argv[++i]);
+            } else if (arg == "--metrics-port" && i + 1 < argc) {
+                metricsPort = stoi(argv[++i]);
+                // -1 is the internal "off" value, so negatives are rejected here
+                if (metricsPort < 0 || metricsPort > 65535) throw out_of_range("--metrics-port");
+            } else if (arg == "--cache" && i + 1 < argc) {
+                cacheDir = argv[++i];
+            } else if (arg == "--store" && i + 1 < argc) {
+                storeFile = argv[++i];
+            } else if (arg == "--top" && i + 1 < argc) {
+                topK = stoul(argv[++i]);
+            } else if (arg == "--sort" && i + 1 < argc) {
+                sortColumnName = argv[++i];
+            } else if (arg == "--index") {
+                rebuildIndex = true;
+            } else if (arg == "--max-dd" && i + 1 < argc) {
+                maxDrawdownFilter = stod(argv[++i]);
+            } else if (arg == "--universe") {
+                universe = true;
+            } else if (arg == "--threads" && i + 1 < argc) {
+                threads = stoul(argv[++i]);
+            }
+        } catch (const logic_error&) {
+            // stoi/stod throw invalid_argument or out_of_range
+            cerr << "Error: invalid value for " << arg << ": " << argv[i] << "\n";
+            return 1;
+        }
+    }
+    
+    if (outputFile.empty()) {
+        outputFile = universe ? "results/universe.csv" : "results/results.csv";
+    }
+    keepStdoutForData({outputFile, binaryFile, jsonFile, ndjsonFile, htmlFile, archiveFile,
+                       seriesFile, traceFile, sampleFile});
+    
+    auto startTime = chrono::steady_clock::now();
+    if (profile) {
+#if BACKTESTER_PROFILING
+        Profiler::enable(true);
+        Profiler::enableCounters(PerfCounters::available());
+#else
+        cerr << "Warning: built with BACKTESTER_PROFILING=0, --profile has no effect\n";
+        profile = false;
+#endif
+    }
+    auto printProfile = [&]() {
+        if (!profile) return;
+        Profiler::printReport(chrono::duration<double>(chrono::steady_clock::now() - startTime).count());
+    };
+    
+    // Tracing starts before any worker thread so every track shares one clock origin
+    if (!traceFile.empty()) {
+        Tracer::enable();
+        Tracer::setThreadName("main");
+    }
+    auto writeTrace = [&]() {
+        if (traceFile.empty()) return;
+        if (!Tracer::writeChromeTrace(traceFile)) {
+            cerr << "Warning: cannot write trace to " << traceFile << "\n";
+            return;
+        }
+        cout << "Trace written to " << traceFile << " (" << Tracer::eventCount() << " events";
+        uint64_t dropped = Tracer::droppedEvents();
+        if (dropped > 0) cout << ", " << dropped << " oldest dropped";
+        cout << ")\n";
+    };
+    
+    if (!sampleFile.empty() && !SamplingProfiler::start(sampleHz)) {
+        cerr << "Warning: sampling profiler unavailable (" << SamplingProfiler::unavailableReason() << ")\n";
+        sampleFile.clear();
+    }
+    auto writeSamples = [&]() {
+        if (sampleFile.empty()) return;
+        SamplingProfiler::stop();
+        if (!SamplingProfiler::writeCollapsed(sampleFile)) {
+            cerr << "Warning: cannot write samples to " << sampleFile << "\n";
+            return;
+        }
+        cout << "CPU samples written to " << sampleFile << " (" << SamplingProfiler::sampleCount()
+             << " samples, " << SamplingProfiler::stackCount() << " distinct stacks";
+        uint64_t dropped = SamplingProfiler::droppedSamples();
+        if (dropped > 0) cout << ", " << dropped << " dropped";
+        cout << ")\n";
+    };
+    
+    // Scrape while the run is in progress; the server stops when main returns
+    unique_ptr<MetricsServer> metricsServer;
+    if (metricsPort >= 0) {
+        try {
+            metricsServer.reset(new MetricsServer(metricsPort));
+            cout << "Metrics served at http://127.0.0.1:" << metricsServer->port() << "/metrics\n";
+        } catch (const exception& e) {
+            cerr << "Warning: " << e.what() << "\n";
         }
     }
     
@@ -131,27 +556,199 @@ int main(int argc, char* argv[]) {
     if (stopLoss > 0) cout << "  ✓ Stop Loss: " << (stopLoss * 100) << "%\n";
     if (takeProfit > 0) cout << "  ✓ Take Profit: " << (takeProfit * 100) << "%\n";
     if (commission > 0) cout << "  ✓ Commission: " << (commission * 100) << "%\n";
+    if (slippage > 0) cout << "  ✓ Slippage: " << (slippage * 100) << "%\n";
     if (useKelly) cout << "  ✓ Kelly Criterion Position Sizing\n";
     
+    BacktestConfig config = {shortMA, longMA, capital, useRSI, useEMA, useMACD,
+                             useBollinger, stopLoss, takeProfit, commission, useKelly, slippage};
+    
     try {
-        // Load data
-        auto data = CSVParser::parse(filename);
-        cout << "\nLoaded " << data.size() << " trading days\n";
-        cout << "Period: " << data.front().date << " to " << data.back().date << "\n";
+        if (universe) {
+            auto files = UniverseReport::listFiles(filename);
+            if (files.empty()) {
+                throw runtime_error("No CSV files in " + filename);
+            }
+            cout << "\nRunning " << files.size() << " symbols on "
+                 << max(1u, threads) << " threads\n";
+            
+            auto summary = UniverseReport::run(files, config, threads);
+            UniverseReport::printSummary(summary);
+            {
+                PROFILE_SCOPE(STAGE_EXPORT, 0);
+                if (!UniverseReport::writeCSV(outputFile, summary)) {
+                    throw runtime_error("Cannot write " + outputFile);
+                }
+            }
+            cout << "\nUniverse report exported to " << outputFile << "\n";
+            printProfile();
+            writeTrace();
+            writeSamples();
+            return 0;
+        }
+        
+        // Identical data, parameters and engine: serve the main run from the cache.
+        // Stages that need the live engine (regimes, cost sweep, series) always simulate.
+        unique_ptr<ResultCache> cache;
+        CacheKey cacheKey;
+        BacktestResult result;
+        bool cacheHit = false;
+        if (!cacheDir.empty()) {
+            cache.reset(new ResultCache(cacheDir));
+            cacheKey = ResultCache::makeKey(filename, config);
+            bool needsEngine = showRegimes || !costSweep.empty() ||
+                               !seriesFile.empty() || !seriesMapFile.empty();
+            cacheHit = !needsEngine && cache->load(cacheKey, result);
+        }
+        
+        // Load data (comparison runs still need it on a cache hit)
+        vector<OHLCV> data;
+        if (!cacheHit || runComparison || optimizePortfolio) {
+            data = CSVParser::parse(filename);
+            cout << "\nLoaded " << data.size() << " trading days\n";
+            cout << "Period: " << data.front().date << " to " << data.back().date << "\n";
+        } else if (!result.dates.empty()) {
+            cout << "\nCached run over " << result.dates.size() << " trading days\n";
+            cout << "Period: " << result.dates.front() << " to " << result.dates.back() << "\n";
+        }
+        
+        ResultColumn sortColumn = COL_SHARPE;
+        if (!ResultStore::columnFromName(sortColumnName, sortColumn)) {
+            throw runtime_error("Unknown sort column: " + sortColumnName);
+        }
+        
+        unique_ptr<ResultStore> store;
+        if (!storeFile.empty()) {
+            store.reset(new ResultStore(storeFile));
+        }
+        
+        unique_ptr<ReportWriter> ndjsonOut;
+        unique_ptr<JsonWriter> ndjson;
+        if (!ndjsonFile.empty()) {
+            ndjsonOut.reset(new ReportWriter(ndjsonFile));
+            if (!ndjsonOut->isOpen()) {
+                throw runtime_error("Cannot open " + ndjsonFile);
+            }
+            ndjson.reset(new JsonWriter(*ndjsonOut));
+        }
         
         // Run comparison if requested
-        if (runComparison) {
-            runStrategyComparison(data, capital);
+        if (runComparison || optimizePortfolio) {
+            runStrategyComparison(data, capital, optimizePortfolio, maxWeight, store.get(), ndjson.get());
         }
         
         // Run main backtest
-        Backtester bt(data, shortMA, longMA, capital, useRSI, useEMA, useMACD, 
-                     useBollinger, stopLoss, takeProfit, commission, useKelly);
-        bt.run();
-        bt.printSummary();
-        bt.exportResults(outputFile);
+        unique_ptr<Backtester> bt;
+        if (cacheHit) {
+            cout << "\nCache hit: " << cacheKey.id << "\n";
+            Backtester::printSummary(result.config.initialCapital, result.finalValue, result.metrics);
+        } else {
+            bt.reset(new Backtester(data, shortMA, longMA, capital, useRSI, useEMA, useMACD,
+                                    useBollinger, stopLoss, takeProfit, commission, useKelly, slippage));
+            bt->setRecordSeries(!seriesFile.empty());
+            if (!seriesMapFile.empty()) {
+                bt->setSeriesFile(seriesMapFile);
+            }
+            bt->run();
+            bt->printSummary();
+            
+            // Cache entries keep the series so a hit can serve --binary and --html too
+            result = bt->getResult(cache || !binaryFile.empty() || !htmlFile.empty());
+            if (cache && !cache->store(cacheKey, result)) {
+                cerr << "Warning: could not store run in cache " << cacheDir << "\n";
+            }
+        }
+        writeRunRecord(ndjson.get(), "main", "", result);
+        
+        // Hand exports to the background writer; analysis below overlaps with disk I/O
+        AsyncResultWriter writer;
+        writer.submit({outputFile, EXPORT_CSV, withoutSeries(result)});
+        if (!binaryFile.empty()) {
+            writer.submit({binaryFile, EXPORT_BINARY, result});
+        }
+        if (!jsonFile.empty()) {
+            writer.submit({jsonFile, EXPORT_JSON, withoutSeries(result)});
+        }
+        if (!htmlFile.empty()) {
+            writer.submit({htmlFile, EXPORT_HTML, result});
+        }
+        
+        if (store) {
+            store->append(result.config, result.metrics);
+            if (rebuildIndex) {
+                store->buildIndex(sortColumn);
+            }
+            if (topK > 0) {
+                printTopResults(*store, sortColumn, topK, maxDrawdownFilter);
+            }
+            store->flush();
+        }
+        if (showRegimes) {
+            printRegimeBreakdown(data, *bt);
+        }
+        if (!costSweep.empty()) {
+            runCostSweep(*bt, costSweep, ndjson.get());
+        }
+        if (!archiveFile.empty()) {
+            PROFILE_SCOPE(STAGE_EXPORT, 0);
+            TradeArchiveWriter archive(archiveFile);
+            if (!archive.isOpen()) {
+                throw runtime_error("Cannot open " + archiveFile);
+            }
+            archive.add(filesystem::path(filename).stem().string(), result.trades);
+            if (!archive.close()) {
+                throw runtime_error("Failed writing " + archiveFile);
+            }
+        }
+        if (!seriesFile.empty()) {
+            PROFILE_SCOPE(STAGE_EXPORT, 0);
+            if (!bt->exportSeries(seriesFile)) {
+                cerr << "Warning: could not write series to " << seriesFile << "\n";
+            }
+        }
+        
+        writer.close();
+        if (ndjsonOut && !ndjsonOut->close()) {
+            cerr << "Warning: run records could not be fully written to " << ndjsonFile << "\n";
+        }
+        if (writer.failedWrites() > 0) {
+            cerr << "Warning: " << writer.failedWrites() << " result file(s) could not be written\n";
+        }
         
         cout << "\nResults exported to " << outputFile << "\n";
+        if (!binaryFile.empty()) {
+            cout << "Binary results exported to " << binaryFile << "\n";
+        }
+        if (!jsonFile.empty()) {
+            cout << "JSON results exported to " << jsonFile << "\n";
+        }
+        if (!ndjsonFile.empty()) {
+            cout << "Run records written to " << ndjsonFile << "\n";
+        }
+        if (!htmlFile.empty()) {
+            cout << "HTML report written to " << htmlFile << "\n";
+        }
+        if (!archiveFile.empty()) {
+            cout << "Trade log archived to " << archiveFile << "\n";
+        }
+        if (!seriesFile.empty()) {
+            cout << "Per-bar series exported to " << seriesFile << "\n";
+        }
+        if (!seriesMapFile.empty()) {
+            cout << "Per-bar series mapped to " << seriesMapFile << "\n";
+        }
+        if (cache) {
+            cache->saveStats();
+            uint64_t lookups = cache->hits() + cache->misses();
+            cout << "Cache " << cacheDir << ": " << cache->hits() << " hits, "
+                 << cache->misses() << " misses";
+            if (lookups > 0) {
+                cout << " (" << setprecision(1) << 100.0 * cache->hits() / lookups << "% hit rate)";
+            }
+            cout << "\n";
+        }
+        printProfile();
+        writeTrace();
+        writeSamples();
         
         // Print resume bullets
         cout << "\n=== RESUME BULLETS ===\n";